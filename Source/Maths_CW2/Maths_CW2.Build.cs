@@ -15,8 +15,10 @@ public class Maths_CW2 : ModuleRules
     "CoreUObject",
     "Engine",
     "InputCore",
-    "SignalProcessing",     // ƴдǷȫһ
-    "ProceduralMeshComponent"
+    "SignalProcessing",     // 检查拼写是否完全一致
+    "ProceduralMeshComponent",
+    "RenderCore",
+    "RHI"
 });
 
         PrivateDependencyModuleNames.AddRange(new string[] {  });
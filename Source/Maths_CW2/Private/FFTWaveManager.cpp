@@ -1,72 +1,207 @@
 #include "FFTWaveManager.h"
-#include "DSP/FloatArrayMath.h" 
-#include "DrawDebugHelpers.h"
+#include "OceanSimulationSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
 //#include "DSP/FastFourierTransform.h"
 //#include "DSP/FastFourierTransform.h"
 
-//캯
+//构造函数
 AFFTWaveManager::AFFTWaveManager()
 {
     PrimaryActorTick.bCanEverTick = true;
 
-    // Ϊڵ
-    OceanMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("OceanMesh"));
+    // 创建组件并设为根节点
+    OceanMesh = CreateDefaultSubobject<UOceanMeshComponent>(TEXT("OceanMesh"));
     RootComponent = OceanMesh;
-
-    // һŻãΪ¸
-    OceanMesh->bUseAsyncCooking = true;
 }
 
 // Called when the game starts or when spawned
 void AFFTWaveManager::BeginPlay()
 {
     Super::BeginPlay();
+    RebuildSimulation();
+}
+
+
+void AFFTWaveManager::RebuildSimulation()
+{
+    // 0. 任意分辨率都可以 (2 的幂 / 混合基 / Bluestein 由 FFT 计划自动选择)，只限制下限
+    MeshResolution = FMath::Max(MeshResolution, 4);
+
+    // 后台任务可能还在读旧的模拟和帧缓冲，先等它结束，旧分辨率的结果也不再使用
+    WaitForSimulation();
+    bHasPendingFrame = false;
+
+    // FFT 计划、缓冲和频谱都在共享的模拟里，同样参数的 Actor 已经建过的话直接共用
     GenerateGrid();
+    AcquireSimulation();
+
+    bGridDirty = false;
 
-    // 1. ʼС
-    int32 TotalSize = MeshResolution * MeshResolution;
-    h0_tilde.Empty();
-    h0_tilde.AddZeroed(TotalSize);
-    h0_tilde_conj.Empty();
-    h0_tilde_conj.AddZeroed(TotalSize);
+    UE_LOG(LogTemp, Warning, TEXT("FFT Wave Initialized: %d points calculated."), MeshResolution * MeshResolution);
+}
 
-    // 2. ʼ˫ѭ
-    for (int32 m = 0; m < MeshResolution; m++)
+
+#if WITH_EDITOR
+void AFFTWaveManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // 用 MemberProperty 的名字，这样修改 WindDirection.X 也能识别出来
+    const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+    if (PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, MeshResolution) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, OceanSize) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, MeshMode) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, SeaSize) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, QuadtreeLevels) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, PatchResolution) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, LOD0Range) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, MorphStartRatio) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, MaxPatches) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, ClipmapLevels) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, ClipmapBlockResolution) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, ClipmapCellSize) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, ClipmapMorphStartRatio))
     {
-        for (int32 n = 0; n < MeshResolution; n++)
-        {
-            // 㲨 k
-            // ӳ䵽 [-N/2, N/2] 
-            float kx = (2.0f * PI * (n - MeshResolution / 2.0f)) / OceanSize;
-            float ky = (2.0f * PI * (m - MeshResolution / 2.0f)) / OceanSize;
-            FVector2D k(kx, ky);
+        bGridDirty = true;
+    }
+    else if (PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, WindSpeed) ||
+             PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, WindDirection) ||
+             PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, Amplitude) ||
+             PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, TimeScale) ||
+             PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, bCullAboveNyquist) ||
+             PropertyName == GET_MEMBER_NAME_CHECKED(AFFTWaveManager, NyquistFadeWidth))
+    {
+        bSpectrumDirty = true;
+    }
+}
+#endif
+
+
+void AFFTWaveManager::SetWindSpeed(float NewWindSpeed)
+{
+    if (WindSpeed == NewWindSpeed) return;
+    WindSpeed = NewWindSpeed;
+    bSpectrumDirty = true;
+}
+
+void AFFTWaveManager::SetWindDirection(FVector2D NewWindDirection)
+{
+    if (WindDirection == NewWindDirection) return;
+    WindDirection = NewWindDirection;
+    bSpectrumDirty = true;
+}
 
-            int32 Index = m * MeshResolution + n;
+void AFFTWaveManager::SetAmplitude(float NewAmplitude)
+{
+    if (Amplitude == NewAmplitude) return;
+    Amplitude = NewAmplitude;
+    bSpectrumDirty = true;
+}
 
-            // ȡ Phillips ֵ
-            float P = CalculatePhillips(k);
+void AFFTWaveManager::SetOceanSize(float NewOceanSize)
+{
+    if (OceanSize == NewOceanSize) return;
+    OceanSize = NewOceanSize;
+    bGridDirty = true;
+}
 
-            // Ϊú˿ȻҪ˹ԣ
-            // ģ˹
-            float r1 = FMath::Frac(FMath::Sin(Index * 12.9898f) * 43758.5453f);
-            float r2 = FMath::Frac(FMath::Sin(Index * 78.233f) * 43758.5453f);
-            float noise = FMath::Sqrt(-2.0f * FMath::Loge(FMath::Max(r1, 0.0001f)));
+void AFFTWaveManager::SetMeshResolution(int32 NewMeshResolution)
+{
+    if (MeshResolution == NewMeshResolution) return;
+    MeshResolution = NewMeshResolution;
+    bGridDirty = true;
+}
 
-            //  h0
-            float Real = noise * FMath::Cos(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
-            float Imag = noise * FMath::Sin(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
 
-            h0_tilde[Index] = Complex(Real, Imag);
+FOceanSpectrumSettings AFFTWaveManager::MakeSpectrumSettings(int32 Resolution) const
+{
+    FOceanSpectrumSettings SpectrumSettings;
+    SpectrumSettings.N = Resolution;
+    SpectrumSettings.OceanSize = OceanSize;
+    SpectrumSettings.Amplitude = Amplitude;
+    SpectrumSettings.WindDirection = WindDirection;
+    SpectrumSettings.WindSpeed = WindSpeed;
+    SpectrumSettings.TimeScale = TimeScale;
+
+    // 只有网格比 FFT 的格点稀 (四叉树 / Clipmap 的格子比 OceanSize / N 大) 时才有画不出来的频点
+    // 单块模式的网格就是 FFT 的格点，不裁剪，也不淡出网格本来画得出来的波
+    const float FinestCellSize = GetFinestCellSize(Resolution);
+    const bool bMeshCoarserThanSimulation = FinestCellSize > OceanSize / FMath::Max(Resolution, 1);
+    SpectrumSettings.CutoffWavelength = (bCullAboveNyquist && bMeshCoarserThanSimulation) ? 2.0f * FinestCellSize : 0.0f;
+    SpectrumSettings.CutoffFadeWidth = NyquistFadeWidth;
+    return SpectrumSettings;
+}
 
-            // 㹲ڶԳԣ FFT ʵ߶ͼļɣ
-            h0_tilde_conj[Index] = std::conj(h0_tilde[Index]);
-        }
+
+float AFFTWaveManager::GetFinestCellSize(int32 Resolution) const
+{
+    // 四叉树：第 0 层一块网格的格子 (CellStride 为 2 的块格子更大)；Clipmap：第 0 层的格子
+    // 按修正之后的设置算 (和实际生成的网格一致)，不依赖 GenerateGrid 是否已经跑过
+    switch (MeshMode)
+    {
+    case EOceanMeshMode::Quadtree:
+    {
+        const FOceanQuadtreeSettings Quadtree = MakeQuadtreeSettings();
+        return Quadtree.GetPatchSize(0) / Quadtree.PatchResolution;
+    }
+    case EOceanMeshMode::Clipmap:
+        return MakeClipmapSettings().BaseCellSize;
+    default:
+        return OceanSize / FMath::Max(Resolution, 1);
     }
+}
+
 
-    UE_LOG(LogTemp, Warning, TEXT("FFT Wave Initialized: %d points calculated."), TotalSize);
+FOceanQuadtreeSettings AFFTWaveManager::MakeQuadtreeSettings() const
+{
+    FOceanQuadtreeSettings Quadtree;
+    Quadtree.SeaSize = SeaSize;
+    Quadtree.NumLevels = QuadtreeLevels;
+    Quadtree.PatchResolution = PatchResolution;
+    Quadtree.LOD0Range = LOD0Range;
+    Quadtree.MorphStartRatio = MorphStartRatio;
+    Quadtree.MaxPatches = MaxPatches;
+    return OceanQuadtree::Sanitize(Quadtree);
 }
 
 
+FOceanClipmapSettings AFFTWaveManager::MakeClipmapSettings() const
+{
+    FOceanClipmapSettings Clipmap;
+    Clipmap.NumLevels = ClipmapLevels;
+    Clipmap.BlockResolution = ClipmapBlockResolution;
+    Clipmap.BaseCellSize = ClipmapCellSize;
+    Clipmap.MorphStartRatio = ClipmapMorphStartRatio;
+    return OceanClipmap::Sanitize(Clipmap);
+}
+
+
+void AFFTWaveManager::AcquireSimulation()
+{
+    bSpectrumDirty = false;
+
+    // 参数变了：正在准备的分辨率作废，开销重新统计
+    CancelPreparedResolution();
+    ResolutionController.Reset();
+
+    const FOceanSpectrumSettings SpectrumSettings = MakeSpectrumSettings(MeshResolution);
+
+    // 先放掉旧的：如果没有别的 Actor 在用，它的内存可以先释放
+    Simulation.Reset();
+
+    UOceanSimulationSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UOceanSimulationSubsystem>() : nullptr;
+    if (Subsystem)
+    {
+        Simulation = Subsystem->AcquireSimulation(SpectrumSettings);
+    }
+    else
+    {
+        Simulation = MakeShared<FOceanSpectrumSimulation>(SpectrumSettings);
+    }
+}
 
 
 void AFFTWaveManager::Tick(float DeltaTime)
@@ -74,305 +209,424 @@ void AFFTWaveManager::Tick(float DeltaTime)
     Super::Tick(DeltaTime);
 
     // ==========================================
-    // 1. ʵʱº˻ (òʵʱЧ)
+    // 1. 海浪基因 (h0) 已缓存，只在参数变化后重算
     // ==========================================
-    
-    h0_tilde.Reset();
-    h0_tilde.AddZeroed(MeshResolution * MeshResolution);
-    h0_tilde_conj.Reset();
-    h0_tilde_conj.AddZeroed(MeshResolution * MeshResolution);
-
-    // ҵ Tick ͷ˫ѭȫ滻
-    for (int32 m = 0; m < MeshResolution; m++)
+    // 后台任务会读模拟的结果和帧缓冲，所以换模拟之前必须先等它结束
+    if (bGridDirty)
     {
-        for (int32 n = 0; n < MeshResolution; n++)
-        {
-            // 1. ȶ k CalculatePhillips(k) ᱨ
-            float kx = (2.0f * PI * (n - MeshResolution / 2.0f)) / OceanSize;
-            float ky = (2.0f * PI * (m - MeshResolution / 2.0f)) / OceanSize;
-            FVector2D k(kx, ky);
+        WaitForSimulation();
+        RebuildSimulation();
+    }
+    else if (bSpectrumDirty)
+    {
+        WaitForSimulation();
+        AcquireSimulation();
+        bHasPendingFrame = false; // 旧频谱算出来的结果作废
+    }
 
-            int32 Index = m * MeshResolution + n;
+    if (!Simulation.IsValid() || Simulation->GetSettings().N != MeshResolution) return;
 
-            // 2. ٵ CalculatePhillips û
-            float P = CalculatePhillips(k);
+    // 自适应分辨率：新的一档在后台准备好之后才切换 (切换时只是交换指针和数组)
+    UpdateAdaptiveResolution();
 
-            // 3. ʹùϣ (ĺ)
-            //  sin Ļԣ Index תһ̶ 0~1 ֮С
-            float r1 = FMath::Frac(FMath::Sin(Index * 12.9898f) * 43758.5453f);
-            float r2 = FMath::Frac(FMath::Sin(Index * 78.233f) * 43758.5453f);
+    // 参数快照：任务运行期间编辑器里改 UPROPERTY 也不会影响正在计算的这一帧
+    FOceanFFTFrameSettings Settings;
+    Settings.N = MeshResolution;
+    Settings.OceanSize = OceanSize;
+    Settings.Choppiness = Choppiness;
 
-            float noise = FMath::Sqrt(-2.0f * FMath::Loge(FMath::Max(r1, 0.0001f)));
-            float Real = noise * FMath::Cos(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
-            float Imag = noise * FMath::Sin(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
+    FOceanFFTParallelSettings Parallel;
+    Parallel.NumThreads = FFTThreadCount;
+    Parallel.MinBatchSize = FFTMinBatchSize;
+
+    // 后台任务还在读上一次的网格块选择结果，改写之前先等它结束
+    // 通常任务在上一帧剩下的时间里早就完成了，这里的 Wait 不会真正阻塞
+    WaitForSimulation();
+
+    // 四叉树：按相机位置选出这一帧要画的网格块
+    Settings.MeshMode = MeshMode;
+    if (MeshMode == EOceanMeshMode::Quadtree)
+    {
+        Settings.Quadtree = QuadtreeSettings;
+        Settings.ViewPosition = GetLocalViewPosition();
+        Settings.QuadtreePatches = &QuadtreePatches;
+        OceanQuadtree::SelectPatches(QuadtreeSettings, Settings.ViewPosition, QuadtreePatches);
+    }
+    else if (MeshMode == EOceanMeshMode::Clipmap)
+    {
+        // Clipmap：每一层按格子大小对齐跟着相机走，拓扑不变
+        Settings.Clipmap = ClipmapSettings;
+        Settings.ViewPosition = GetLocalViewPosition();
+        Settings.ClipmapLevels = &ClipmapLevelInfos;
 
-            h0_tilde[Index] = Complex(Real, Imag);
-            h0_tilde_conj[Index] = std::conj(h0_tilde[Index]);
+        const FVector2f OldOrigin = ClipmapLevelInfos.Num() > 0 ? ClipmapLevelInfos.Last().Origin : FVector2f(FLT_MAX, FLT_MAX);
+        OceanClipmap::UpdateLevels(ClipmapSettings, Settings.ViewPosition, ClipmapLevelInfos);
+
+        // 最外层移动了才需要更新包围盒
+        const FVector2f NewOrigin = ClipmapLevelInfos.Last().Origin;
+        if (OceanMesh && (NewOrigin.X != OldOrigin.X || NewOrigin.Y != OldOrigin.Y))
+        {
+            OceanMesh->SetLocalBounds(OceanClipmap::GetBounds(ClipmapSettings, ClipmapLevelInfos));
         }
     }
 
     // ==========================================
-    // 2. ʱݻ IFFT 
+    // 2. 向共享的模拟请求海面，再在后台对结果采样生成网格
     // ==========================================
-    float Time = GetWorld()->GetTimeSeconds() * TimeScale;
-    TArray<Complex> h_tilde_t;
-    h_tilde_t.SetNum(MeshResolution * MeshResolution);
+    // 同一片海每个时间每帧只算一次：同一帧里先请求的 Actor 启动任务，后面请求同一时间的直接共用
+    FOceanTimeSliceSettings TimeSlice;
+    TimeSlice.bEnabled = bTimeSlicedSimulation;
+    TimeSlice.BudgetMs = TimeSliceBudgetMs;
+    TimeSlice.RowsPerChunk = TimeSliceRowsPerChunk;
+
+    const float CurrentTime = GetWorld()->GetTimeSeconds() * TimeScale;
+    if (!bAsyncSimulation || !bHasPendingFrame)
+    {
+        // 同步模式 (或者异步的第一帧 / 刚重建过，还没有可用结果)：算出时间 t 的海面，等它完成直接提交
+        LaunchFrame(CurrentTime, Settings, Parallel, TimeSlice);
+        WaitForSimulation();
+        bHasPendingFrame = false;
+        BackFrameIndex = 1 - BackFrameIndex;
+        PublishFrame(Frames[1 - BackFrameIndex]);
+
+        if (!bAsyncSimulation) return;
+    }
+    else
+    {
+        // 交换前后缓冲：后缓冲已经完整写好 (上一帧在后台算的 t)，变成前缓冲给网格使用
+        BackFrameIndex = 1 - BackFrameIndex;
+        PublishFrame(Frames[1 - BackFrameIndex]);
+    }
+
+    // 异步模式：在后台提前计算下一帧的时间 t + dt，下一次 Tick 直接提交
+    LaunchFrame((GetWorld()->GetTimeSeconds() + DeltaTime) * TimeScale, Settings, Parallel, TimeSlice);
+    bHasPendingFrame = true;
+}
+
+
+void AFFTWaveManager::LaunchFrame(float Time, const FOceanFFTFrameSettings& Settings, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice)
+{
+    const UE::Tasks::FTask SharedTask = Simulation->Simulate(Time, Parallel, TimeSlice);
+
+    FOceanSurfaceSampler Sampler = Simulation->GetSampler();
+    Sampler.Choppiness = Settings.Choppiness;
 
-    for (int32 m = 0; m < MeshResolution; m++)
+    // 在后台写入后缓冲 (共享模拟的任务完成之后才开始)，并登记为这块结果的读者
+    FOceanMeshStreams* BackFrame = &Frames[BackFrameIndex];
+    SimulationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Settings, Sampler, BackFrame]()
     {
-        for (int32 n = 0; n < MeshResolution; n++)
-        {
-            int32 Index = m * MeshResolution + n;
+        const double StartTime = FPlatformTime::Seconds();
+        BuildFrame(Settings, Sampler, *BackFrame);
+        LastBuildMs.store((float)((FPlatformTime::Seconds() - StartTime) * 1000.0), std::memory_order_relaxed);
+    }, UE::Tasks::Prerequisites(SharedTask));
+    Simulation->AddReader(SimulationTask);
+}
+
+
+void AFFTWaveManager::WaitForSimulation()
+{
+    if (SimulationTask.IsValid())
+    {
+        SimulationTask.Wait();
+        SimulationTask = UE::Tasks::FTask();
+    }
+}
 
-            float kx = (2.0f * PI * (n - MeshResolution / 2.0f)) / OceanSize;
-            float ky = (2.0f * PI * (m - MeshResolution / 2.0f)) / OceanSize;
-            float kMag = FMath::Sqrt(kx * kx + ky * ky);
 
-            // ļ (ֱ)
-            if (kMag < 0.0001f)
-            {
-                h_tilde_t[Index] = Complex(0, 0);
-                continue;
-            }
+void AFFTWaveManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // 任务持有 this 和帧缓冲的指针，Actor 销毁之前必须等它结束
+    WaitForSimulation();
+    bHasPendingFrame = false;
+    CancelPreparedResolution();
+    Simulation.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+FVector3f AFFTWaveManager::GetLocalViewPosition() const
+{
+    FVector ViewLocation = GetActorLocation();
+
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController && PlayerController->PlayerCameraManager)
+    {
+        ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+    }
+
+    return (FVector3f)GetActorTransform().InverseTransformPosition(ViewLocation);
+}
 
-            float Omega = FMath::Sqrt(9.81f * kMag);
-            float Phase = Omega * Time;
-            Complex ExpIPhase(FMath::Cos(Phase), FMath::Sin(Phase));
-            Complex ExpINegPhase(FMath::Cos(-Phase), FMath::Sin(-Phase));
 
-            h_tilde_t[Index] = h0_tilde[Index] * ExpIPhase + h0_tilde_conj[Index] * ExpINegPhase;
+void AFFTWaveManager::PublishFrame(FOceanMeshStreams& Frame)
+{
+    // 5. 提交
+    // UV 和索引在 GenerateGrid 里上传后就不再变化 (静态流)，每帧只把位置和切线交给渲染线程
+    // 数据已经是 GPU 格式，组件只交换数组，不拷贝
+    if (!OceanMesh) return;
+
+    const double StartTime = FPlatformTime::Seconds();
+    OceanMesh->SwapStreams(Frame);
+    LastPublishMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+
+void AFFTWaveManager::UpdateAdaptiveResolution()
+{
+    if (!AdaptiveResolution.bEnabled)
+    {
+        CancelPreparedResolution();
+        return;
+    }
+
+    // 1. 正在准备：准备好了就切换，没好就继续用旧的
+    if (PrepareTask.IsValid())
+    {
+        if (PrepareTask.IsCompleted())
+        {
+            ApplyPreparedResolution();
         }
+        return;
     }
 
-    // ִ IDFT
-    TArray<Complex> TempRowOutput;
-    TempRowOutput.SetNum(MeshResolution * MeshResolution);
-    TArray<Complex> FinalHeightField;
-    FinalHeightField.SetNum(MeshResolution * MeshResolution);
+    // 2. 上一帧的开销 = 共享模拟 + 生成顶点 + 提交 (共享的模拟算给每个使用者，保守一些)
+    const float CostMs = Simulation->GetLastRunMs() + LastBuildMs.load(std::memory_order_relaxed) + LastPublishMs;
+    const int32 NewResolution = ResolutionController.Update(AdaptiveResolution, MeshResolution, CostMs);
+    if (NewResolution != MeshResolution)
+    {
+        StartPrepareResolution(NewResolution);
+    }
+}
 
-    for (int32 m = 0; m < MeshResolution; m++) PerformIDFT_Row(m, h_tilde_t, TempRowOutput);
-    for (int32 n = 0; n < MeshResolution; n++) PerformIDFT_Col(n, TempRowOutput, FinalHeightField);
 
-    // ==========================================
-    // 3. Ӧø߶㷨 ( 65x65 )
-    // ==========================================
+void AFFTWaveManager::StartPrepareResolution(int32 NewResolution)
+{
+    TSharedRef<FPreparedResolution> Prepared = MakeShared<FPreparedResolution>();
+    Prepared->Resolution = NewResolution;
 
-    // [Ҫ] ҪֱӱȽ NumΪ Vertices ܶһȦ (65x65 vs 64x64)
-    // ֻҪȷ Vertices 㹻༴
-    if (Vertices.Num() < FinalHeightField.Num()) return;
+    // 别的 Actor 已经在用这一档的模拟的话直接拿来，不用再建
+    const FOceanSpectrumSettings SpectrumSettings = MakeSpectrumSettings(NewResolution);
+    UOceanSimulationSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UOceanSimulationSubsystem>() : nullptr;
+    if (Subsystem)
+    {
+        Prepared->Simulation = Subsystem->FindSimulation(SpectrumSettings);
+    }
 
-    int32 NumVerts = MeshResolution + 1; //  65
+    // 四叉树 / Clipmap 的网格与分辨率无关，只有单块模式要换网格
+    const bool bBuildSimulation = !Prepared->Simulation.IsValid();
+    const bool bBuildTopology = MeshMode == EOceanMeshMode::SingleTile;
+    const int32 NumVerts = NewResolution + 1;
+    const float StepSize = OceanSize / NewResolution;
 
-    // һȸе Z  (߶ȳ)
-    // ע⣺ Vertices (65x65) FinalHeightField
-    for (int32 m = 0; m < NumVerts; m++)
+    // 后台任务只碰 Prepared (共享指针)，Actor 不等它，放弃时直接丢掉即可
+    PreparedResolution = Prepared;
+    PrepareTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Prepared, SpectrumSettings, bBuildSimulation, bBuildTopology, NumVerts, StepSize]()
     {
-        for (int32 n = 0; n < NumVerts; n++)
+        if (bBuildSimulation)
         {
-            int32 VertexIndex = m * NumVerts + n;
-
-            // [߼] ӳ 65 -> 64
-            //  n=64 ʱȡģ 0ʵ޷
-            int32 fft_m = m % MeshResolution;
-            int32 fft_n = n % MeshResolution;
-            int32 FFTIndex = fft_m * MeshResolution + fft_n;
-
-            // ȫ
-            if (FinalHeightField.IsValidIndex(FFTIndex) && Vertices.IsValidIndex(VertexIndex))
-            {
-                float Height = FinalHeightField[FFTIndex].real();
-                Vertices[VertexIndex].Z = Height * 0.005f; // ˸ϵ
-            }
+            Prepared->Simulation = MakeShared<FOceanSpectrumSimulation>(SpectrumSettings);
         }
+        if (bBuildTopology)
+        {
+            Prepared->Topology = UOceanMeshComponent::BuildGridTopology(NumVerts, NumVerts, StepSize, 1, true);
+            Prepared->bHasTopology = true;
+        }
+    });
+}
+
+
+void AFFTWaveManager::ApplyPreparedResolution()
+{
+    TSharedPtr<FPreparedResolution> Prepared = MoveTemp(PreparedResolution);
+    PrepareTask = UE::Tasks::FTask();
+
+    // 准备期间改了网格模式：拓扑对不上，等下一次判断
+    if (!Prepared.IsValid() || !Prepared->Simulation.IsValid() || Prepared->bHasTopology != (MeshMode == EOceanMeshMode::SingleTile))
+    {
+        ResolutionController.Reset();
+        return;
     }
 
-    // ڶڴ߶ȳ㷨ߣӦƫ
-    for (int32 m = 0; m < NumVerts; m++)
+    const int32 OldResolution = MeshResolution;
+
+    // 后台任务还在读旧的模拟和帧缓冲
+    WaitForSimulation();
+    bHasPendingFrame = false;
+
+    MeshResolution = Prepared->Resolution;
+    if (Prepared->bHasTopology)
     {
-        for (int32 n = 0; n < NumVerts; n++)
+        const int32 NumVerts = MeshResolution + 1;
+        for (FOceanMeshStreams& Frame : Frames)
+        {
+            Frame.SetNumUninitialized(NumVerts * NumVerts);
+        }
+
+        if (OceanMesh)
         {
-            int32 Index = m * NumVerts + n;
-
-            // --- A. 㷨 ---
-            float H_Current = Vertices[Index].Z;
-
-            // ھ߼ ( 65x65)
-            //  n+1 ˱߽ (65)ȡģصͷ
-            int32 RightN = (n + 1) % MeshResolution;
-            // ע⣺ȡ߶ʱҪȥ FFT ݶӦ"Ǹ״"
-            // Ϊ˼򵥣ֱ Vertices "߼ϵھ"
-            //  Vertices Ѿ 65x65 βغϵģֱȡ n+1 ɣ n=64
-
-            // Ƚֱƫ
-            int32 IndexRight = m * NumVerts + ((n == MeshResolution) ? 1 : n + 1);
-            int32 IndexBottom = ((m == MeshResolution) ? 1 : m + 1) * NumVerts + n;
-
-            // ֹԽ (Ȼϲᣬȫһ)
-            if (!Vertices.IsValidIndex(IndexRight) || !Vertices.IsValidIndex(IndexBottom)) continue;
-
-            float H_Right = Vertices[IndexRight].Z;
-            float H_Bottom = Vertices[IndexBottom].Z;
-
-            float Step = OceanSize / MeshResolution;
-            FVector VectorRight(Step, 0, H_Right - H_Current);
-            FVector VectorBottom(0, Step, H_Bottom - H_Current);
-
-            FVector NewNormal = FVector::CrossProduct(VectorBottom, VectorRight).GetSafeNormal();
-            Normals[Index] = NewNormal * -1.0f;
-
-            // --- B. Ӧ Choppiness (ƫ X/Y) ---
-            float Choppiness = 1.5f;
-            if (Choppiness > 0.0f)
-            {
-                // ָԭʼλ
-                float OriginalX = n * Step;
-                float OriginalY = m * Step;
-
-                // 1. ԭƫƶ
-                float OffsetX = Normals[Index].X * Choppiness * Vertices[Index].Z * 0.5f;
-                float OffsetY = Normals[Index].Y * Choppiness * Vertices[Index].Z * 0.5f;
-
-                // 2. [ؼ޸] ƫֹը
-                // ƫԲܳһ룬ͻᴩ
-                float MaxOffset = Step * 0.4f; // һ㰲ȫ (0.4)
-
-                OffsetX = FMath::Clamp(OffsetX, -MaxOffset, MaxOffset);
-                OffsetY = FMath::Clamp(OffsetY, -MaxOffset, MaxOffset);
-
-                // 3. Ӧƺƫ
-                Vertices[Index].X = OriginalX - OffsetX;
-                Vertices[Index].Y = OriginalY - OffsetY;
-            }
+            OceanMesh->InitializeGrid(MoveTemp(Prepared->Topology));
         }
     }
 
-    // 4. ύ
-    OceanMesh->UpdateMeshSection(0, Vertices, Normals, UVs, Colors, Tangents);
-}
+    // 登记到子系统，让同样参数的 Actor 也能共用 (期间别人已经建了一份的话用那一份)
+    Simulation.Reset();
+    UOceanSimulationSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UOceanSimulationSubsystem>() : nullptr;
+    Simulation = Subsystem ? Subsystem->RegisterSimulation(Prepared->Simulation.ToSharedRef()) : Prepared->Simulation;
 
+    ResolutionController.Reset();
 
+    UE_LOG(LogTemp, Log, TEXT("Ocean resolution %d -> %d (average cost %.2f ms, target %.2f ms)."),
+        OldResolution, MeshResolution, ResolutionController.GetAverageCostMs(), AdaptiveResolution.TargetMs);
+}
 
 
-float AFFTWaveManager::CalculatePhillips(FVector2D k)
+void AFFTWaveManager::CancelPreparedResolution()
 {
-    float kLength = k.Size();
-    if (kLength < 0.000001f) return 0.0f; //  0
-
-    float kLength2 = kLength * kLength;
-    float kLength4 = kLength2 * kLength2;
-
-    // L_constant = v^2 / g
-    float L_constant = (WindSpeed * WindSpeed) / 9.81f;
-    float L2 = L_constant * L_constant;
-
-    // ӣ˷ļн
-    FVector2D WindDir = WindDirection;
-    WindDir.Normalize();
-    FVector2D kDir = k;
-    kDir.Normalize();
-    float dot = FVector2D::DotProduct(kDir, WindDir);
-    float dot2 = dot * dot;
-
-    // Phillips ʽʵ
-    return Amplitude * (FMath::Exp(-1.0f / (kLength2 * L2)) / kLength4) * dot2;
+    // 后台任务只持有 Prepared 的共享指针，不需要等它
+    PreparedResolution.Reset();
+    PrepareTask = UE::Tasks::FTask();
 }
 
 
-// ɳʼ
-void AFFTWaveManager::GenerateGrid()
+// 一帧的顶点 / 法线：对共享模拟的结果采样
+// 只读取模拟结果和参数快照，只写 OutFrame，可以在后台线程运行
+void AFFTWaveManager::BuildFrame(const FOceanFFTFrameSettings& Settings, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutFrame)
 {
-    Vertices.Reset();
-    Triangles.Reset();
-    UVs.Reset();
-    Normals.Reset();
-    Tangents.Reset();
-    Colors.Reset();
-
-    // [޸] Ҫ N+1 Χ N 
-    int32 NumVerts = MeshResolution + 1;
-    float StepSize = OceanSize / MeshResolution;
+    const int32 N = Settings.N;
+    if (!Sampler.IsValid() || Sampler.N != N) return;
 
-    for (int32 m = 0; m < NumVerts; m++) // ע NumVerts ( <= MeshResolution)
+    // 四叉树 / Clipmap 模式：每块网格按世界位置对这块周期性海面采样
+    if (Settings.MeshMode != EOceanMeshMode::SingleTile)
     {
-        for (int32 n = 0; n < NumVerts; n++)
+        if (Settings.MeshMode == EOceanMeshMode::Quadtree && Settings.QuadtreePatches)
         {
-            Vertices.Add(FVector(n * StepSize, m * StepSize, 0.0f));
-
-            // UV  (0~1)
-            UVs.Add(FVector2D(n / (float)MeshResolution, m / (float)MeshResolution));
-            Normals.Add(FVector(0, 0, 1));
-            Tangents.Add(FProcMeshTangent(1, 0, 0));
-            Colors.Add(FColor::White);
-
-            //  (ֻڲ߽ʱ)
-            if (n < MeshResolution && m < MeshResolution)
-            {
-                // [ע] ڵп NumVerts (65) 64
-                int32 Current = m * NumVerts + n;
-                int32 Right = Current + 1;
-                int32 Bottom = Current + NumVerts;
-                int32 BottomRight = Bottom + 1;
-
-                Triangles.Add(Current);
-                Triangles.Add(Bottom);
-                Triangles.Add(Right);
-
-                Triangles.Add(Right);
-                Triangles.Add(Bottom);
-                Triangles.Add(BottomRight);
-            }
+            OceanQuadtree::BuildVertices(Settings.Quadtree, *Settings.QuadtreePatches, Settings.ViewPosition, Sampler, OutFrame);
         }
+        else if (Settings.MeshMode == EOceanMeshMode::Clipmap && Settings.ClipmapLevels)
+        {
+            OceanClipmap::BuildVertices(Settings.Clipmap, *Settings.ClipmapLevels, Sampler, OutFrame);
+        }
+        return;
     }
 
-    if (OceanMesh)
+    // ==========================================
+    // 4. 应用高度与计算法线 (适配 65x65 网格)
+    // ==========================================
+    // 模拟结果的各个通道 (N x N)
+    const float* FinalHeightField = Sampler.Height;
+    const float* DispXField = Sampler.DispX;
+    const float* DispYField = Sampler.DispY;
+    const float* SlopeXField = Sampler.SlopeX;
+    const float* SlopeYField = Sampler.SlopeY;
+    const float HeightScale = Sampler.HeightScale;
+
+    // Vertices 比 FFT 结果多一圈 (65x65 vs 64x64)
+    int32 NumVerts = N + 1;
+    TArray<FVector3f>& FrameVertices = OutFrame.Positions;
+    TArray<FOceanMeshTangent>& FrameTangents = OutFrame.Tangents;
+    if (FrameVertices.Num() < NumVerts * NumVerts || FrameTangents.Num() < NumVerts * NumVerts) return;
+
+    // 一遍按行顺序写完：每个顶点只读一次各个通道，位置 (高度 + Choppy 偏移) 和切线一起写出
+    // x' = x + Choppiness * D，其中 D = IFFT(-i*k/|k|*h) = -位移通道；法线 n = normalize(-dh/dx, -dh/dy, 1)
+    float Step = Settings.OceanSize / N;
+    const float ChopScale = Settings.Choppiness * HeightScale;
+    for (int32 m = 0; m < N; m++)
     {
-        OceanMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, Colors, Tangents, false);
-        if (OceanMaterial) OceanMesh->SetMaterial(0, OceanMaterial);
+        const int32 FFTRow = m * N;
+        FVector3f* RowVertices = FrameVertices.GetData() + m * NumVerts;
+        FOceanMeshTangent* RowTangents = FrameTangents.GetData() + m * NumVerts;
+        const float OriginalY = m * Step;
+
+        for (int32 n = 0; n < N; n++)
+        {
+            const int32 FFTIndex = FFTRow + n;
+            RowVertices[n] = FVector3f(
+                n * Step - ChopScale * DispXField[FFTIndex],
+                OriginalY - ChopScale * DispYField[FFTIndex],
+                FinalHeightField[FFTIndex] * HeightScale);
+
+            const float SlopeX = SlopeXField[FFTIndex] * HeightScale;
+            const float SlopeY = SlopeYField[FFTIndex] * HeightScale;
+            RowTangents[n] = UOceanMeshComponent::MakeTangent(FVector3f(-SlopeX, -SlopeY, 1.0f).GetSafeNormal());
+        }
+
+        // [核心逻辑] 映射 65 -> 64：最后一列就是第一列向 +X 平移一块海面，直接拷贝，实现无缝连接
+        RowVertices[N] = RowVertices[0] + FVector3f(Settings.OceanSize, 0.0f, 0.0f);
+        RowTangents[N] = RowTangents[0];
+    }
+
+    // 最后一行同理：第一行向 +Y 平移一块海面
+    const FVector3f* FirstRow = FrameVertices.GetData();
+    FVector3f* LastRow = FrameVertices.GetData() + N * NumVerts;
+    for (int32 n = 0; n < NumVerts; n++)
+    {
+        LastRow[n] = FirstRow[n] + FVector3f(0.0f, Settings.OceanSize, 0.0f);
     }
+    FMemory::Memcpy(FrameTangents.GetData() + N * NumVerts, FrameTangents.GetData(), NumVerts * sizeof(FOceanMeshTangent));
 }
 
 
 
-// --- д IDFT 㷨 (ᷨO(N^3) Ӷȣ 64x64 㹻) ---
 
-void AFFTWaveManager::PerformIDFT_Row(int32 RowIndex, const TArray<Complex>& Input, TArray<Complex>& Output)
+// 生成初始网格
+void AFFTWaveManager::GenerateGrid()
 {
-    // ÿһ 1D IDFT
-    for (int32 x = 0; x < MeshResolution; x++)
+    // 四叉树模式：MaxPatches 块同样大小的网格，每帧按相机重新摆放
+    if (MeshMode == EOceanMeshMode::Quadtree)
     {
-        Complex Sum(0, 0);
-        for (int32 k = 0; k < MeshResolution; k++)
-        {
-            // ȡƵ (Input  h_tilde_t)
-            int32 InputIndex = RowIndex * MeshResolution + k;
+        QuadtreeSettings = MakeQuadtreeSettings();
 
-            // ŷʽe^(i * 2 * PI * k * x / N)
-            float Angle = 2.0f * PI * k * x / MeshResolution;
-            Complex Exp(FMath::Cos(Angle), FMath::Sin(Angle));
+        const int32 PatchVerts = QuadtreeSettings.PatchResolution + 1;
+        for (FOceanMeshStreams& Frame : Frames)
+        {
+            Frame.SetNumUninitialized(QuadtreeSettings.MaxPatches * QuadtreeSettings.GetVertsPerPatch());
+        }
 
-            Sum += Input[InputIndex] * Exp;
+        if (OceanMesh)
+        {
+            const float HalfSea = QuadtreeSettings.SeaSize * 0.5f;
+            OceanMesh->InitializeGrid(PatchVerts, PatchVerts, 1.0f, QuadtreeSettings.MaxPatches);
+            OceanMesh->SetLocalBounds(FBox(FVector(-HalfSea, -HalfSea, 0.0f), FVector(HalfSea, HalfSea, 0.0f)));
+            if (OceanMaterial) OceanMesh->SetMaterial(0, OceanMaterial);
         }
-        // 
-        Output[RowIndex * MeshResolution + x] = Sum;
+        return;
     }
-}
 
-void AFFTWaveManager::PerformIDFT_Col(int32 ColIndex, const TArray<Complex>& Input, TArray<Complex>& Output)
-{
-    // ÿһ 1D IDFT
-    for (int32 y = 0; y < MeshResolution; y++)
+    // Clipmap 模式：每层 4 x 4 块 (环形的层 12 块)，顶点数固定，之后只平移不重建
+    if (MeshMode == EOceanMeshMode::Clipmap)
     {
-        Complex Sum(0, 0);
-        for (int32 k = 0; k < MeshResolution; k++)
-        {
-            // עǰ Row Ľ
-            int32 InputIndex = k * MeshResolution + ColIndex;
+        ClipmapSettings = MakeClipmapSettings();
+        ClipmapLevelInfos.Reset(); // 第一次 Tick 时按相机位置摆放
 
-            float Angle = 2.0f * PI * k * y / MeshResolution;
-            Complex Exp(FMath::Cos(Angle), FMath::Sin(Angle));
+        const int32 BlockVerts = ClipmapSettings.BlockResolution + 1;
+        for (FOceanMeshStreams& Frame : Frames)
+        {
+            Frame.SetNumUninitialized(ClipmapSettings.GetNumBlocks() * ClipmapSettings.GetVertsPerBlock());
+        }
 
-            Sum += Input[InputIndex] * Exp;
+        if (OceanMesh)
+        {
+            OceanMesh->InitializeGrid(BlockVerts, BlockVerts, 1.0f, ClipmapSettings.GetNumBlocks());
+            if (OceanMaterial) OceanMesh->SetMaterial(0, OceanMaterial);
         }
-        Output[y * MeshResolution + ColIndex] = Sum;
+        return;
+    }
+
+    // [核心修改] 我们需要 N+1 个点来围成 N 个格子
+    int32 NumVerts = MeshResolution + 1;
+    float StepSize = OceanSize / MeshResolution;
+
+    // 两个帧缓冲按顶点数分配好 (X/Y/Z 和法线每帧都会被完整覆盖)
+    for (FOceanMeshStreams& Frame : Frames)
+    {
+        Frame.SetNumUninitialized(NumVerts * NumVerts);
+    }
+
+    // 平面网格、UV (0~1) 和三角形索引都由组件生成
+    if (OceanMesh)
+    {
+        OceanMesh->InitializeGrid(NumVerts, NumVerts, StepSize);
+        if (OceanMaterial) OceanMesh->SetMaterial(0, OceanMaterial);
     }
-}
\ No newline at end of file
+}
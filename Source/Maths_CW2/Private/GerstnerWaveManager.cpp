@@ -1,47 +1,53 @@
 #include "GerstnerWaveManager.h"
+#include "OceanGerstner.h"
+#include "OceanStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gerstner Update"), STAT_OceanGerstnerUpdate, STATGROUP_Ocean);
 
 AGerstnerWaveManager::AGerstnerWaveManager()
 {
     PrimaryActorTick.bCanEverTick = true;
 
-    OceanMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("OceanMesh"));
+    OceanMesh = CreateDefaultSubobject<UOceanMeshComponent>(TEXT("OceanMesh"));
     RootComponent = OceanMesh;
-    OceanMesh->bUseAsyncCooking = true;
 
-    // --- ŻĲ˲ (ظ) ---
-    // ɣʹ"Ǳ"Ĳ ()ҲҪָһָһ
+    // --- 优化的波浪参数 (打破重复感) ---
+    // 技巧：使用"非倍数"的波长 (质数)，方向也要这指一下那指一下
 
-    // 1. ӿ (Main Swell) - 
+    // 1. 主涌浪 (Main Swell) - 负责大起伏
     FGerstnerWave W1; W1.Direction = FVector2D(1.0f, 0.1f);   W1.Wavelength = 512.0f; W1.Steepness = 0.12f; W1.Amplitude = 25.0f;
     Waves.Add(W1);
 
-    // 2. μ (Secondary) - ΢ƫһ㷽
+    // 2. 次级浪 (Secondary) - 稍微偏一点方向
     FGerstnerWave W2; W2.Direction = FVector2D(0.7f, 0.5f);   W2.Wavelength = 233.0f; W2.Steepness = 0.12f; W2.Amplitude = 12.0f;
     Waves.Add(W2);
 
-    // 3.  (Crossing Swell) - Ƹ
+    // 3. 侧向干扰浪 (Crossing Swell) - 用来打破纵向的条纹感
     FGerstnerWave W3; W3.Direction = FVector2D(-0.4f, 0.8f);  W3.Wavelength = 113.0f; W3.Steepness = 0.10f; W3.Amplitude = 6.0f;
     Waves.Add(W3);
 
-    // 4. С - ӻҶ
+    // 4. 反向小碎浪 - 增加混乱度
     FGerstnerWave W4; W4.Direction = FVector2D(0.2f, -0.6f);  W4.Wavelength = 67.0f;  W4.Steepness = 0.10f; W4.Amplitude = 3.0f;
     Waves.Add(W4);
 
-    // --- Ӹϸڲ (Ϊôģ) ---
+    // --- 增加更多细节层 (为了让它不那么像低模) ---
 
-    // 5. ϸ A
+    // 5. 细节 A
     FGerstnerWave W5; W5.Direction = FVector2D(-0.6f, -0.2f); W5.Wavelength = 41.0f;  W5.Steepness = 0.08f; W5.Amplitude = 1.5f;
     Waves.Add(W5);
 
-    // 6. ϸ B
+    // 6. 细节 B
     FGerstnerWave W6; W6.Direction = FVector2D(0.8f, -0.4f);  W6.Wavelength = 23.0f;  W6.Steepness = 0.08f; W6.Amplitude = 0.8f;
     Waves.Add(W6);
 
-    // 7. ϸ C
+    // 7. 细节 C
     FGerstnerWave W7; W7.Direction = FVector2D(-0.3f, 0.9f);  W7.Wavelength = 13.0f;  W7.Steepness = 0.06f; W7.Amplitude = 0.4f;
     Waves.Add(W7);
 
-    // 8. ϸ D
+    // 8. 细节 D
     FGerstnerWave W8; W8.Direction = FVector2D(0.5f, 0.3f);   W8.Wavelength = 7.0f;   W8.Steepness = 0.05f; W8.Amplitude = 0.2f;
     Waves.Add(W8);
 }
@@ -52,66 +58,158 @@ void AGerstnerWaveManager::BeginPlay()
     GenerateGrid();
 }
 
+#if WITH_EDITOR
+void AGerstnerWaveManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // 用 MemberProperty 的名字，这样修改 Waves[i].Wavelength 也能识别出来
+    if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(AGerstnerWaveManager, Waves))
+    {
+        bWaveTableDirty = true;
+    }
+}
+#endif
+
+void AGerstnerWaveManager::SetWaves(const TArray<FGerstnerWave>& NewWaves)
+{
+    Waves = NewWaves;
+    bWaveTableDirty = true;
+}
+
+void AGerstnerWaveManager::SetWave(int32 Index, const FGerstnerWave& NewWave)
+{
+    if (!Waves.IsValidIndex(Index)) return;
+    Waves[Index] = NewWave;
+    bWaveTableDirty = true;
+}
+
+void FGerstnerWaveTable::Build(const TArray<FGerstnerWave>& InWaves)
+{
+    const int32 NumWaves = InWaves.Num();
+    K.SetNumUninitialized(NumWaves);
+    Speed.SetNumUninitialized(NumWaves);
+    DirX.SetNumUninitialized(NumWaves);
+    DirY.SetNumUninitialized(NumWaves);
+    Amplitude.SetNumUninitialized(NumWaves);
+    Steepness.SetNumUninitialized(NumWaves);
+
+    for (int32 w = 0; w < NumWaves; w++)
+    {
+        const FGerstnerWave& W = InWaves[w];
+
+        // 防止除以0
+        const float Wavelength = FMath::Max(W.Wavelength, 10.0f);
+        const float k = 2.0f * PI / Wavelength;
+        const FVector2D Dir = W.Direction.GetSafeNormal();
+
+        K[w] = k;
+        Speed[w] = FMath::Sqrt(9.81f / k);
+        DirX[w] = (float)Dir.X;
+        DirY[w] = (float)Dir.Y;
+        Amplitude[w] = W.Amplitude;
+        Steepness[w] = W.Steepness;
+    }
+}
+
+void FGerstnerWaveTable::BuildVisible(const FGerstnerWaveTable& Source, float CutoffWavelength, float FadeWidth)
+{
+    K.Reset();
+    Speed.Reset();
+    DirX.Reset();
+    DirY.Reset();
+    Amplitude.Reset();
+    Steepness.Reset();
+
+    for (int32 w = 0; w < Source.Num(); w++)
+    {
+        const float Fade = OceanFFT::GetWavelengthFade(2.0f * PI / Source.K[w], CutoffWavelength, FadeWidth);
+        if (Fade <= 0.0f) continue;
+
+        // 陡度不变：水平位移 Q*A 跟着振幅一起淡出
+        K.Add(Source.K[w]);
+        Speed.Add(Source.Speed[w]);
+        DirX.Add(Source.DirX[w]);
+        DirY.Add(Source.DirY[w]);
+        Amplitude.Add(Source.Amplitude[w] * Fade);
+        Steepness.Add(Source.Steepness[w]);
+    }
+}
+
 void AGerstnerWaveManager::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
-    // ȡʱ
+    // 获取时间
     float Time = GetWorld()->GetTimeSeconds() * TimeScale;
 
-    // ²
+    // 更新波浪物理 (连同提交一起计时，给自适应分辨率用)
+    const double StartTime = FPlatformTime::Seconds();
     UpdateWaves(Time);
+    UpdateAdaptiveResolution((float)((FPlatformTime::Seconds() - StartTime) * 1000.0));
 }
 
-void AGerstnerWaveManager::GenerateGrid()
+void AGerstnerWaveManager::UpdateAdaptiveResolution(float CostMs)
 {
-    Vertices.Reset();
-    Triangles.Reset();
-    UVs.Reset();
-    Normals.Reset();
-    Tangents.Reset();
-    Colors.Reset();
-
-    //  N+1 Ապ
-    int32 NumVerts = MeshResolution + 1;
-    float StepSize = OceanSize / MeshResolution;
+    if (!AdaptiveResolution.bEnabled)
+    {
+        PreparedResolution.Reset();
+        PrepareTask = UE::Tasks::FTask();
+        return;
+    }
 
-    for (int32 m = 0; m < NumVerts; m++)
+    // 1. 正在准备：准备好了就切换 (只是把数组移进来)，没好就继续用旧的
+    if (PrepareTask.IsValid())
     {
-        for (int32 n = 0; n < NumVerts; n++)
-        {
-            // ʼƽλ
-            Vertices.Add(FVector(n * StepSize, m * StepSize, 0.0f));
-            UVs.Add(FVector2D(n / (float)MeshResolution, m / (float)MeshResolution));
+        if (!PrepareTask.IsCompleted()) return;
+
+        TSharedPtr<FPreparedResolution> Prepared = MoveTemp(PreparedResolution);
+        PrepareTask = UE::Tasks::FTask();
+        ResolutionController.Reset();
+        if (!Prepared.IsValid()) return;
+
+        const int32 OldResolution = MeshResolution;
+        MeshResolution = Prepared->Resolution;
+        GridResolution = MeshResolution;
+        Streams.SetNumUninitialized(Prepared->Topology.GetNumVertices());
+        OceanMesh->InitializeGrid(MoveTemp(Prepared->Topology));
+
+        UE_LOG(LogTemp, Log, TEXT("Gerstner resolution %d -> %d (average cost %.2f ms, target %.2f ms)."),
+            OldResolution, MeshResolution, ResolutionController.GetAverageCostMs(), AdaptiveResolution.TargetMs);
+        return;
+    }
 
-            // ĬϷߺ
-            Normals.Add(FVector(0, 0, 1));
-            Tangents.Add(FProcMeshTangent(1, 0, 0));
-            Colors.Add(FColor::White);
+    // 2. 需要换一档：网格拓扑在后台生成，任务只碰 Prepared
+    const int32 NewResolution = ResolutionController.Update(AdaptiveResolution, MeshResolution, CostMs);
+    if (NewResolution == MeshResolution) return;
 
-            // 
-            if (n < MeshResolution && m < MeshResolution)
-            {
-                int32 Current = m * NumVerts + n;
-                int32 Right = Current + 1;
-                int32 Bottom = Current + NumVerts;
-                int32 BottomRight = Bottom + 1;
-
-                Triangles.Add(Current);
-                Triangles.Add(Bottom);
-                Triangles.Add(Right);
-
-                Triangles.Add(Right);
-                Triangles.Add(Bottom);
-                Triangles.Add(BottomRight);
-            }
-        }
-    }
+    TSharedRef<FPreparedResolution> Prepared = MakeShared<FPreparedResolution>();
+    Prepared->Resolution = NewResolution;
+    const float StepSize = OceanSize / NewResolution;
 
-    OceanMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, Colors, Tangents, false);
+    PreparedResolution = Prepared;
+    PrepareTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Prepared, StepSize]()
+    {
+        const int32 NumVerts = Prepared->Resolution + 1;
+        Prepared->Topology = UOceanMeshComponent::BuildGridTopology(NumVerts, NumVerts, StepSize, 1, true);
+    });
+}
 
-    // 2. [] Ӧò
-    // ûǷڱ༭ѡ˲ʣѡˣ͸ Section 0
+void AGerstnerWaveManager::GenerateGrid()
+{
+    // 生成 N+1 个点以闭合网格
+    int32 NumVerts = MeshResolution + 1;
+    float StepSize = OceanSize / MeshResolution;
+    GridResolution = MeshResolution;
+
+    // 位置和切线每帧都会被完整覆盖，这里只分配
+    Streams.SetNumUninitialized(NumVerts * NumVerts);
+
+    // 平面网格、三角形索引和静态 UV 都由组件生成
+    OceanMesh->InitializeGrid(NumVerts, NumVerts, StepSize);
+
+    // 2. [新增] 应用材质
+    // 检查用户是否在编辑器里选了材质，如果选了，就赋给 Section 0
     if (OceanMaterial)
     {
         OceanMesh->SetMaterial(0, OceanMaterial);
@@ -120,80 +218,89 @@ void AGerstnerWaveManager::GenerateGrid()
 
 void AGerstnerWaveManager::UpdateWaves(float Time)
 {
-    int32 NumVerts = MeshResolution + 1;
+    SCOPE_CYCLE_COUNTER(STAT_OceanGerstnerUpdate);
 
-    // 1. жλ
-    for (int32 i = 0; i < Vertices.Num(); i++)
-    {
-        // ԭλ
-        FVector BasePos = FVector(UVs[i].X * OceanSize, UVs[i].Y * OceanSize, 0.0f);
-        FVector FinalPos = BasePos;
-        FinalPos.Z = 0;
+    TArray<FVector3f>& Vertices = Streams.Positions;
+    TArray<FOceanMeshTangent>& Tangents = Streams.Tangents;
 
-        for (const FGerstnerWave& W : Waves)
+    // 0. 波浪的常量 (k, c, 方向...) 只在 Waves 改变之后重建；每个波的相位 k*c*t 每帧只算一次
+    // 网格画不出来的短波 (波长 <= 2 倍格子间距) 在这里去掉，不再进入顶点循环；截止波长随分辨率变化
+    const float Cutoff = bCullAboveNyquist ? 2.0f * OceanSize / GridResolution : 0.0f;
+    if (bWaveTableDirty || Cutoff != VisibleCutoff || NyquistFadeWidth != VisibleFadeWidth)
+    {
+        if (bWaveTableDirty)
         {
-            // ֹ0
-            float Wavelength = FMath::Max(W.Wavelength, 10.0f);
-            float k = 2.0f * PI / Wavelength;
-            float c = FMath::Sqrt(9.81f / k);
-            FVector2D Dir = W.Direction.GetSafeNormal();
-
-            float Dot = FVector2D::DotProduct(Dir, FVector2D(BasePos.X, BasePos.Y));
-            float Theta = k * (Dot - c * Time);
-
-            float SinVal = FMath::Sin(Theta);
-            float CosVal = FMath::Cos(Theta);
-
-            // Z λ (߶)
-            FinalPos.Z += W.Amplitude * SinVal;
-
-            // --- [ؼ޸ 1] ״޸ ---
-            // ֮ǰĹʽ (Steepness/k) * Amplitude ˵λƽıը
-            // ڸΪֱ steepness Ϊ 0~1 ϵ
-            // ֻҪ Steepness * Amplitude < Wavelength / 2PIͲ
-            // Ǽ򵥴ֱó˷֤ը
-            float HorizontalOffset = W.Steepness * W.Amplitude * CosVal;
-
-            FinalPos.X -= Dir.X * HorizontalOffset;
-            FinalPos.Y -= Dir.Y * HorizontalOffset;
+            WaveTable.Build(Waves);
+            bWaveTableDirty = false;
         }
-        Vertices[i] = FinalPos;
+
+        VisibleWaves.BuildVisible(WaveTable, Cutoff, NyquistFadeWidth);
+        VisibleCutoff = Cutoff;
+        VisibleFadeWidth = NyquistFadeWidth;
     }
 
-    // 2. ¼㷨
-    for (int32 m = 0; m < NumVerts; m++)
+    const int32 NumWaves = VisibleWaves.Num();
+    WavePhases.SetNumUninitialized(NumWaves, EAllowShrinking::No);
+    for (int32 w = 0; w < NumWaves; w++)
     {
-        for (int32 n = 0; n < NumVerts; n++)
-        {
-            int32 Index = m * NumVerts + n;
-
-            // Ѱھ (Ե)
-            int32 n_next = (n == NumVerts - 1) ? n - 1 : n + 1;
-            int32 m_next = (m == NumVerts - 1) ? m - 1 : m + 1;
-
-            int32 IndexRight = m * NumVerts + n_next;
-            int32 IndexBottom = m_next * NumVerts + n;
+        WavePhases[w] = VisibleWaves.K[w] * VisibleWaves.Speed[w] * Time;
+    }
 
-            FVector P_Current = Vertices[Index];
-            FVector P_Right = Vertices[IndexRight];
-            FVector P_Bottom = Vertices[IndexBottom];
+    FOceanGerstnerWaves KernelWaves;
+    KernelWaves.Num = NumWaves;
+    KernelWaves.K = VisibleWaves.K.GetData();
+    KernelWaves.DirX = VisibleWaves.DirX.GetData();
+    KernelWaves.DirY = VisibleWaves.DirY.GetData();
+    KernelWaves.Amplitude = VisibleWaves.Amplitude.GetData();
+    KernelWaves.Steepness = VisibleWaves.Steepness.GetData();
+    KernelWaves.Phase = WavePhases.GetData();
+
+    // 1. 逐行求位移和法线 (偏导数的解析式，见 OceanGerstner::EvaluateRowScalar)，波数多时改用 FFT 合成
+    // 基础位置是规则网格 (n*Step, m*Step)，一行的顶点连续存放，SIMD 内核每次处理 4 个
+    const int32 NumVerts = GridResolution + 1;
+    if (Vertices.Num() < NumVerts * NumVerts || Tangents.Num() < NumVerts * NumVerts) return;
+
+    const float Step = OceanSize / GridResolution;
+    FVector3f* VertexData = Vertices.GetData();
+    FOceanMeshTangent* TangentData = Tangents.GetData();
+
+    if (FFTSynthesisWaveCount > 0 && NumWaves >= FFTSynthesisWaveCount)
+    {
+        // 波很多：放进频率网格做一次逆 FFT，开销和波数无关
+        if (Spectrum.GetResolution() != GridResolution || Spectrum.GetOceanSize() != OceanSize)
+        {
+            Spectrum.Initialize(GridResolution, OceanSize);
+        }
 
-            FVector V_Horizontal = P_Right - P_Current;
-            FVector V_Vertical = P_Bottom - P_Current;
+        FOceanFFTParallelSettings Parallel;
+        Parallel.NumThreads = FFTThreadCount;
+        Spectrum.Evaluate(KernelWaves, VertexData, TangentData, Parallel);
+    }
+    else
+    {
+        // 顶点之间互不依赖：按行切成几块分给工作线程，每块直接写进最终的数组 (不同的块写不同的行)
+        const int32 NumChunks = (UpdateChunkCount > 0)
+            ? FMath::Min(UpdateChunkCount, NumVerts)
+            : FMath::Clamp(FMath::DivideAndRoundUp(NumVerts, 8), 1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
 
-            // Եҵĵ㣬Ҫ
-            if (n == NumVerts - 1) V_Horizontal *= -1.0f;
-            if (m == NumVerts - 1) V_Vertical *= -1.0f;
+        // 每块一份递推状态 (行首求一次 sin / cos，之后沿着行旋转)，按 16 字节对齐给 SIMD 读写
+        const int32 ChunkScratchSize = Align(OceanGerstner::GetRowScratchSize(NumWaves), 16);
+        KernelScratch.SetNumUninitialized(NumChunks * ChunkScratchSize, EAllowShrinking::No);
 
-            // --- [ؼ޸ 2] ɫ/޸ ---
-            // ֮ǰ CrossProduct(V_Vertical, V_Horizontal) ǳµ (0,0,-1)
-            // ԺǺڵġ
-            // ڽ˳Horizontal x Vertical = Up (0,0,1)
-            FVector NewNormal = FVector::CrossProduct(V_Horizontal, V_Vertical).GetSafeNormal();
-            Normals[Index] = NewNormal;
-        }
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 RowBegin = (int32)((int64)NumVerts * Chunk / NumChunks);
+            const int32 RowEnd = (int32)((int64)NumVerts * (Chunk + 1) / NumChunks);
+            float* Scratch = KernelScratch.GetData() + Chunk * ChunkScratchSize;
+            for (int32 m = RowBegin; m < RowEnd; m++)
+            {
+                OceanGerstner::EvaluateRow(KernelWaves, 0.0f, Step, m * Step, NumVerts,
+                    VertexData + m * NumVerts, TangentData + m * NumVerts, Scratch);
+            }
+        }, NumChunks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
     }
 
-    // 3. ύ
-    OceanMesh->UpdateMeshSection(0, Vertices, Normals, UVs, Colors, Tangents);
+    // 2. 提交更新
+    // 只提交变化的位置和切线 (交换数组，不拷贝)，UV 和索引是静态的
+    OceanMesh->SwapStreams(Streams);
 }
\ No newline at end of file
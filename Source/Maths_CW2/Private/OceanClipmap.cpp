@@ -0,0 +1,124 @@
+#include "OceanClipmap.h"
+
+namespace OceanClipmap
+{
+    FOceanClipmapSettings Sanitize(const FOceanClipmapSettings& Settings)
+    {
+        FOceanClipmapSettings Result = Settings;
+        Result.NumLevels = FMath::Clamp(Result.NumLevels, 1, 16);
+        Result.BlockResolution = FMath::Clamp(Result.BlockResolution, 2, 254) & ~1; // 偶数，Geomorphing 才能对齐到外层
+        Result.BaseCellSize = FMath::Max(Result.BaseCellSize, 0.01f);
+
+        // 过渡区域必须在洞的外面 (洞的边缘在半径的 1/2 处)，否则洞边上的格点会被挪开
+        Result.MorphStartRatio = FMath::Clamp(Result.MorphStartRatio, 0.55f, 0.95f);
+        return Result;
+    }
+
+    void UpdateLevels(const FOceanClipmapSettings& Settings, const FVector3f& ViewPosition, TArray<FOceanClipmapLevel>& OutLevels)
+    {
+        OutLevels.SetNum(Settings.NumLevels);
+
+        const int32 LevelRes = Settings.GetLevelResolution();
+        for (int32 Level = 0; Level < Settings.NumLevels; Level++)
+        {
+            // 1. 以相机为中心，左下角对齐到 2 倍格子大小 (这样每层的偶数格点都落在外层的格点上)
+            const float CellSize = Settings.GetCellSize(Level);
+            const float SnapSize = 2.0f * CellSize;
+            const float HalfExtent = 0.5f * LevelRes * CellSize;
+
+            FOceanClipmapLevel& Info = OutLevels[Level];
+            Info.CellSize = CellSize;
+            Info.Origin.X = FMath::FloorToFloat((ViewPosition.X - HalfExtent) / SnapSize) * SnapSize;
+            Info.Origin.Y = FMath::FloorToFloat((ViewPosition.Y - HalfExtent) / SnapSize) * SnapSize;
+            Info.HoleShiftX = 0;
+            Info.HoleShiftY = 0;
+        }
+
+        // 2. 洞的标准位置是本层的第 BlockResolution 个格点，内层实际的位置与它最多差一个格子
+        for (int32 Level = 1; Level < Settings.NumLevels; Level++)
+        {
+            FOceanClipmapLevel& Info = OutLevels[Level];
+            const FOceanClipmapLevel& Inner = OutLevels[Level - 1];
+            const float HoleX = Info.Origin.X + Settings.BlockResolution * Info.CellSize;
+            const float HoleY = Info.Origin.Y + Settings.BlockResolution * Info.CellSize;
+            Info.HoleShiftX = FMath::Clamp(FMath::RoundToInt((Inner.Origin.X - HoleX) / Info.CellSize), 0, 1);
+            Info.HoleShiftY = FMath::Clamp(FMath::RoundToInt((Inner.Origin.Y - HoleY) / Info.CellSize), 0, 1);
+        }
+    }
+
+    FBox GetBounds(const FOceanClipmapSettings& Settings, const TArray<FOceanClipmapLevel>& Levels)
+    {
+        if (Levels.Num() == 0) return FBox(ForceInit);
+
+        const FOceanClipmapLevel& Outer = Levels.Last();
+        const float Extent = Settings.GetLevelResolution() * Outer.CellSize;
+        return FBox(FVector(Outer.Origin.X, Outer.Origin.Y, 0.0f), FVector(Outer.Origin.X + Extent, Outer.Origin.Y + Extent, 0.0f));
+    }
+
+    void BuildVertices(const FOceanClipmapSettings& Settings, const TArray<FOceanClipmapLevel>& Levels, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutStreams)
+    {
+        const int32 BlockRes = Settings.BlockResolution;
+        const int32 BlockVerts = BlockRes + 1;
+        const int32 VertsPerBlock = Settings.GetVertsPerBlock();
+        const int32 HalfRes = 2 * BlockRes;
+        if (Levels.Num() != Settings.NumLevels || OutStreams.Num() < Settings.GetNumBlocks() * VertsPerBlock || !Sampler.IsValid()) return;
+
+        const float InvMorphLength = 1.0f / (1.0f - Settings.MorphStartRatio);
+
+        int32 BlockIndex = 0;
+        for (int32 Level = 0; Level < Settings.NumLevels; Level++)
+        {
+            const FOceanClipmapLevel& Info = Levels[Level];
+
+            for (int32 by = 0; by < 4; by++)
+            {
+                for (int32 bx = 0; bx < 4; bx++)
+                {
+                    // 环形的层跳过中间 2 x 2 块 (由内层覆盖)
+                    const bool bCentre = (bx == 1 || bx == 2) && (by == 1 || by == 2);
+                    if (Level > 0 && bCentre) continue;
+
+                    FVector3f* Positions = OutStreams.Positions.GetData() + BlockIndex * VertsPerBlock;
+                    FOceanMeshTangent* Tangents = OutStreams.Tangents.GetData() + BlockIndex * VertsPerBlock;
+                    BlockIndex++;
+
+                    for (int32 m = 0; m < BlockVerts; m++)
+                    {
+                        for (int32 n = 0; n < BlockVerts; n++)
+                        {
+                            // 1. 本层的格点下标 (0 ~ 4 * BlockRes)
+                            const int32 i = bx * BlockRes + n;
+                            const int32 j = by * BlockRes + m;
+
+                            // 2. Geomorphing：靠近本层外边缘时，奇数格点滑向偶数格点 (外层的格点)，到边缘时完全重合
+                            const float Radius = FMath::Max(FMath::Abs(i - HalfRes), FMath::Abs(j - HalfRes)) / (float)HalfRes;
+                            const float Morph = FMath::Clamp((Radius - Settings.MorphStartRatio) * InvMorphLength, 0.0f, 1.0f);
+                            float GridX = i - (i & 1) * Morph;
+                            float GridY = j - (j & 1) * Morph;
+
+                            // 洞边上的格点 (i, j 都在 m ~ 3m 之间) 跟着内层平移，与内层外边缘的偶数格点一一重合
+                            // 只动洞边这一圈，本层的外边缘保持不变，旁边的一排格子被拉长或压扁 (最多压成 0)
+                            // 洞边的 Radius 不超过 1/2，不会同时有 Geomorphing
+                            const bool bHoleEdge = Level > 0 && i >= BlockRes && i <= 3 * BlockRes && j >= BlockRes && j <= 3 * BlockRes;
+                            if (bHoleEdge)
+                            {
+                                GridX += Info.HoleShiftX;
+                                GridY += Info.HoleShiftY;
+                            }
+
+                            // 3. 对周期性的海面采样
+                            const float X = Info.Origin.X + GridX * Info.CellSize;
+                            const float Y = Info.Origin.Y + GridY * Info.CellSize;
+                            FVector3f Offset, Normal;
+                            Sampler.Sample(X, Y, Offset, Normal);
+
+                            const int32 Index = m * BlockVerts + n;
+                            Positions[Index] = FVector3f(X, Y, 0.0f) + Offset;
+                            Tangents[Index] = UOceanMeshComponent::MakeTangent(Normal);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
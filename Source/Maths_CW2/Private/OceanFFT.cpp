@@ -0,0 +1,771 @@
+#include "OceanFFT.h"
+#include "OceanStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("FFT 2D Columns"), STAT_OceanFFT2DColumns, STATGROUP_Ocean);
+DECLARE_CYCLE_STAT(TEXT("FFT 2D Rows"), STAT_OceanFFT2DRows, STATGROUP_Ocean);
+
+static TAutoConsoleVariable<int32> CVarOceanFFTSIMD(
+    TEXT("ocean.FFT.SIMD"),
+    1,
+    TEXT("Use VectorRegister4Float butterflies in the ocean FFT.\n")
+    TEXT("0 = scalar reference path, 1 = SIMD (default)."),
+    ECVF_Default);
+
+namespace OceanFFT
+{
+    // 根据线程设置把 NumItems 行 (列) 分成多少块
+    static int32 GetNumChunks(int32 NumItems, const FOceanFFTParallelSettings& Parallel)
+    {
+        const int32 MaxThreads = (Parallel.NumThreads > 0)
+            ? Parallel.NumThreads
+            : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+        const int32 MinBatch = FMath::Max(Parallel.MinBatchSize, 1);
+        return FMath::Clamp(FMath::DivideAndRoundUp(NumItems, MinBatch), 1, MaxThreads);
+    }
+
+    // 把 [0, NumItems) 均匀切成 NumChunks 段并行执行，Body(Chunk, Begin, End)
+    template <typename BodyType>
+    static void ParallelForChunks(int32 NumItems, int32 NumChunks, const BodyType& Body)
+    {
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 Begin = (int32)((int64)NumItems * Chunk / NumChunks);
+            const int32 End = (int32)((int64)NumItems * (Chunk + 1) / NumChunks);
+            Body(Chunk, Begin, End);
+        }, NumChunks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+    }
+
+    // 每个任务块的缓冲按 16 个 float (64 字节) 对齐，避免不同线程写同一条缓存行
+    static int32 AlignChunkSize(int32 NumFloats)
+    {
+        return Align(FMath::Max(NumFloats, 1), 16);
+    }
+
+    // 标量蝶形：长度为 Len 的一级，WRe / WIm 是这一级的旋转因子
+    static void ButterflyStageScalar(float* Re, float* Im, int32 Size, int32 Len, const float* WRe, const float* WIm)
+    {
+        const int32 Half = Len / 2;
+        for (int32 Start = 0; Start < Size; Start += Len)
+        {
+            float* ARe = Re + Start;
+            float* AIm = Im + Start;
+            float* BRe = ARe + Half;
+            float* BIm = AIm + Half;
+            for (int32 j = 0; j < Half; j++)
+            {
+                // T = W * B
+                const float TRe = WRe[j] * BRe[j] - WIm[j] * BIm[j];
+                const float TIm = WRe[j] * BIm[j] + WIm[j] * BRe[j];
+
+                BRe[j] = ARe[j] - TRe;
+                BIm[j] = AIm[j] - TIm;
+                ARe[j] = ARe[j] + TRe;
+                AIm[j] = AIm[j] + TIm;
+            }
+        }
+    }
+
+    // --- 混合基用的小点数逆 DFT：Y[u] = sum A[r] * e^(+i*2*PI*r*u/Radix) ---
+
+    template <int32 Radix>
+    static void SmallInverseDFT(const float* ARe, const float* AIm, float* YRe, float* YIm);
+
+    template <>
+    void SmallInverseDFT<2>(const float* ARe, const float* AIm, float* YRe, float* YIm)
+    {
+        YRe[0] = ARe[0] + ARe[1];  YIm[0] = AIm[0] + AIm[1];
+        YRe[1] = ARe[0] - ARe[1];  YIm[1] = AIm[0] - AIm[1];
+    }
+
+    template <>
+    void SmallInverseDFT<3>(const float* ARe, const float* AIm, float* YRe, float* YIm)
+    {
+        const float S60 = 0.86602540378f; // sin(2*PI/3)
+
+        const float SumRe = ARe[1] + ARe[2];
+        const float SumIm = AIm[1] + AIm[2];
+        const float DiffRe = S60 * (ARe[1] - ARe[2]);
+        const float DiffIm = S60 * (AIm[1] - AIm[2]);
+        const float MidRe = ARe[0] - 0.5f * SumRe;
+        const float MidIm = AIm[0] - 0.5f * SumIm;
+
+        YRe[0] = ARe[0] + SumRe;   YIm[0] = AIm[0] + SumIm;
+        YRe[1] = MidRe - DiffIm;   YIm[1] = MidIm + DiffRe;   // Mid + i*Diff
+        YRe[2] = MidRe + DiffIm;   YIm[2] = MidIm - DiffRe;   // Mid - i*Diff
+    }
+
+    template <>
+    void SmallInverseDFT<4>(const float* ARe, const float* AIm, float* YRe, float* YIm)
+    {
+        const float S02Re = ARe[0] + ARe[2], S02Im = AIm[0] + AIm[2];
+        const float D02Re = ARe[0] - ARe[2], D02Im = AIm[0] - AIm[2];
+        const float S13Re = ARe[1] + ARe[3], S13Im = AIm[1] + AIm[3];
+        const float D13Re = ARe[1] - ARe[3], D13Im = AIm[1] - AIm[3];
+
+        YRe[0] = S02Re + S13Re;   YIm[0] = S02Im + S13Im;
+        YRe[1] = D02Re - D13Im;   YIm[1] = D02Im + D13Re;     // D02 + i*D13
+        YRe[2] = S02Re - S13Re;   YIm[2] = S02Im - S13Im;
+        YRe[3] = D02Re + D13Im;   YIm[3] = D02Im - D13Re;     // D02 - i*D13
+    }
+
+    template <>
+    void SmallInverseDFT<5>(const float* ARe, const float* AIm, float* YRe, float* YIm)
+    {
+        const float C1 = 0.30901699437f;  // cos(2*PI/5)
+        const float C2 = -0.80901699437f; // cos(4*PI/5)
+        const float S1 = 0.95105651630f;  // sin(2*PI/5)
+        const float S2 = 0.58778525229f;  // sin(4*PI/5)
+
+        const float B1Re = ARe[1] + ARe[4], B1Im = AIm[1] + AIm[4];
+        const float B2Re = ARe[2] + ARe[3], B2Im = AIm[2] + AIm[3];
+        const float D1Re = ARe[1] - ARe[4], D1Im = AIm[1] - AIm[4];
+        const float D2Re = ARe[2] - ARe[3], D2Im = AIm[2] - AIm[3];
+
+        const float M1Re = ARe[0] + C1 * B1Re + C2 * B2Re, M1Im = AIm[0] + C1 * B1Im + C2 * B2Im;
+        const float M2Re = ARe[0] + C2 * B1Re + C1 * B2Re, M2Im = AIm[0] + C2 * B1Im + C1 * B2Im;
+        const float R1Re = S1 * D1Re + S2 * D2Re, R1Im = S1 * D1Im + S2 * D2Im;
+        const float R2Re = S2 * D1Re - S1 * D2Re, R2Im = S2 * D1Im - S1 * D2Im;
+
+        YRe[0] = ARe[0] + B1Re + B2Re;   YIm[0] = AIm[0] + B1Im + B2Im;
+        YRe[1] = M1Re - R1Im;            YIm[1] = M1Im + R1Re;    // M1 + i*R1
+        YRe[4] = M1Re + R1Im;            YIm[4] = M1Im - R1Re;    // M1 - i*R1
+        YRe[2] = M2Re - R2Im;            YIm[2] = M2Im + R2Re;    // M2 + i*R2
+        YRe[3] = M2Re + R2Im;            YIm[3] = M2Im - R2Re;    // M2 - i*R2
+    }
+
+    // Stockham 一级：把长度 n = Radix * SubLength 的子序列拆开，结果写入 Dst (自动排序)
+    template <int32 Radix>
+    static void StockhamStage(const float* SrcRe, const float* SrcIm, float* DstRe, float* DstIm,
+        int32 SubLength, int32 Stride, const float* TwRe, const float* TwIm)
+    {
+        for (int32 p = 0; p < SubLength; p++)
+        {
+            const float* WRe = TwRe + p * (Radix - 1);
+            const float* WIm = TwIm + p * (Radix - 1);
+
+            for (int32 q = 0; q < Stride; q++)
+            {
+                float ARe[Radix], AIm[Radix], YRe[Radix], YIm[Radix];
+                for (int32 r = 0; r < Radix; r++)
+                {
+                    const int32 In = q + Stride * (p + r * SubLength);
+                    ARe[r] = SrcRe[In];
+                    AIm[r] = SrcIm[In];
+                }
+
+                SmallInverseDFT<Radix>(ARe, AIm, YRe, YIm);
+
+                const int32 OutBase = q + Stride * (Radix * p);
+                DstRe[OutBase] = YRe[0];
+                DstIm[OutBase] = YIm[0];
+                for (int32 u = 1; u < Radix; u++)
+                {
+                    const int32 Out = OutBase + Stride * u;
+                    DstRe[Out] = YRe[u] * WRe[u - 1] - YIm[u] * WIm[u - 1];
+                    DstIm[Out] = YRe[u] * WIm[u - 1] + YIm[u] * WRe[u - 1];
+                }
+            }
+        }
+    }
+}
+
+FOceanFFTPlan::FOceanFFTPlan(int32 InSize)
+{
+    Initialize(InSize);
+}
+
+bool FOceanFFTPlan::IsSupportedSize(int32 InSize)
+{
+    return InSize >= 1;
+}
+
+bool FOceanFFTPlan::UseSIMD()
+{
+    return CVarOceanFFTSIMD.GetValueOnAnyThread() != 0;
+}
+
+int32 FOceanFFTPlan::GetWorkSize() const
+{
+    switch (Algorithm)
+    {
+    case EAlgorithm::MixedRadix: return 2 * Size;
+    case EAlgorithm::Bluestein:  return 2 * BluesteinSize;
+    default:                     return 0;
+    }
+}
+
+void FOceanFFTPlan::Initialize(int32 InSize)
+{
+    Size = 0;
+    Algorithm = EAlgorithm::Radix2;
+    BitReverse.Reset();
+    TwiddleRe.Reset();
+    TwiddleIm.Reset();
+    Stages.Reset();
+    BluesteinSize = 0;
+    BluesteinPlan.Reset();
+    ChirpRe.Reset();
+    ChirpIm.Reset();
+    KernelRe.Reset();
+    KernelIm.Reset();
+
+    if (!IsSupportedSize(InSize))
+    {
+        UE_LOG(LogTemp, Error, TEXT("FOceanFFTPlan: unsupported size %d."), InSize);
+        return;
+    }
+
+    Size = InSize;
+
+    // ==========================================
+    // 1. 2 的幂：原地 radix-2
+    // ==========================================
+    if (FMath::IsPowerOfTwo(Size))
+    {
+        Algorithm = EAlgorithm::Radix2;
+        const int32 Log2Size = FMath::FloorLog2(Size);
+
+        // 位反转表
+        BitReverse.SetNumUninitialized(Size);
+        for (int32 i = 0; i < Size; i++)
+        {
+            int32 Reversed = 0;
+            for (int32 Bit = 0; Bit < Log2Size; Bit++)
+            {
+                Reversed |= ((i >> Bit) & 1) << (Log2Size - 1 - Bit);
+            }
+            BitReverse[i] = Reversed;
+        }
+
+        // 每一级的旋转因子 e^(+i*2*PI*j/L)，用 double 计算避免累积误差 (下标 0 不使用)
+        TwiddleRe.SetNumZeroed(Size);
+        TwiddleIm.SetNumZeroed(Size);
+        for (int32 Len = 2; Len <= Size; Len <<= 1)
+        {
+            const int32 Half = Len / 2;
+            for (int32 j = 0; j < Half; j++)
+            {
+                const double Angle = 2.0 * UE_DOUBLE_PI * j / Len;
+                TwiddleRe[Half + j] = (float)FMath::Cos(Angle);
+                TwiddleIm[Half + j] = (float)FMath::Sin(Angle);
+            }
+        }
+        return;
+    }
+
+    // ==========================================
+    // 2. 只含 2/3/5 因子：Stockham 混合基 (优先用 radix-4)
+    // ==========================================
+    TArray<int32> Factors;
+    int32 Remaining = Size;
+    for (int32 Radix : { 4, 2, 3, 5 })
+    {
+        while (Remaining % Radix == 0)
+        {
+            Factors.Add(Radix);
+            Remaining /= Radix;
+        }
+    }
+
+    if (Remaining == 1)
+    {
+        Algorithm = EAlgorithm::MixedRadix;
+
+        int32 Length = Size;
+        int32 Stride = 1;
+        int32 TwiddleCount = 0;
+        for (int32 Radix : Factors)
+        {
+            FStage& Stage = Stages.AddDefaulted_GetRef();
+            Stage.Radix = Radix;
+            Stage.SubLength = Length / Radix;
+            Stage.Stride = Stride;
+            Stage.TwiddleOffset = TwiddleCount;
+
+            TwiddleCount += Stage.SubLength * (Radix - 1);
+            Length = Stage.SubLength;
+            Stride *= Radix;
+        }
+
+        // 第 p 组第 u 个输出乘以 e^(+i*2*PI*p*u/n)，n 是本级的子序列长度
+        TwiddleRe.SetNumUninitialized(TwiddleCount);
+        TwiddleIm.SetNumUninitialized(TwiddleCount);
+        for (const FStage& Stage : Stages)
+        {
+            const int32 StageLength = Stage.Radix * Stage.SubLength;
+            for (int32 p = 0; p < Stage.SubLength; p++)
+            {
+                for (int32 u = 1; u < Stage.Radix; u++)
+                {
+                    const double Angle = 2.0 * UE_DOUBLE_PI * p * u / StageLength;
+                    const int32 Index = Stage.TwiddleOffset + p * (Stage.Radix - 1) + (u - 1);
+                    TwiddleRe[Index] = (float)FMath::Cos(Angle);
+                    TwiddleIm[Index] = (float)FMath::Sin(Angle);
+                }
+            }
+        }
+        return;
+    }
+
+    // ==========================================
+    // 3. 其他长度：Bluestein
+    // ==========================================
+    // n*k = (n^2 + k^2 - (k-n)^2) / 2，所以 X[k] = w[k] * sum (x[n]*w[n]) * conj(w[k-n])
+    // 其中 w[n] = e^(+i*PI*n^2/N)，求和是一个循环卷积，补零到 2 的幂后用 radix-2 计算
+    Algorithm = EAlgorithm::Bluestein;
+    BluesteinSize = (int32)FMath::RoundUpToPowerOfTwo(2 * Size - 1);
+    BluesteinPlan = MakeShared<FOceanFFTPlan>(BluesteinSize);
+
+    ChirpRe.SetNumUninitialized(Size);
+    ChirpIm.SetNumUninitialized(Size);
+    for (int32 n = 0; n < Size; n++)
+    {
+        // n^2 先对 2N 取模，避免大数的精度问题
+        const int64 Square = ((int64)n * n) % (2 * (int64)Size);
+        const double Angle = UE_DOUBLE_PI * (double)Square / Size;
+        ChirpRe[n] = (float)FMath::Cos(Angle);
+        ChirpIm[n] = (float)FMath::Sin(Angle);
+    }
+
+    // 卷积核 b[m] = conj(w[|m|])，循环排列；预先做一次变换并除以长度
+    KernelRe.SetNumZeroed(BluesteinSize);
+    KernelIm.SetNumZeroed(BluesteinSize);
+    KernelRe[0] = ChirpRe[0];
+    KernelIm[0] = -ChirpIm[0];
+    for (int32 m = 1; m < Size; m++)
+    {
+        KernelRe[m] = KernelRe[BluesteinSize - m] = ChirpRe[m];
+        KernelIm[m] = KernelIm[BluesteinSize - m] = -ChirpIm[m];
+    }
+
+    BluesteinPlan->InverseInPlace(KernelRe.GetData(), KernelIm.GetData(), nullptr);
+
+    const float InvLength = 1.0f / BluesteinSize;
+    for (int32 m = 0; m < BluesteinSize; m++)
+    {
+        KernelRe[m] *= InvLength;
+        KernelIm[m] *= InvLength;
+    }
+}
+
+void FOceanFFTPlan::InverseInPlace(float* Re, float* Im, float* Work) const
+{
+    InverseInPlace(Re, Im, Work, UseSIMD());
+}
+
+void FOceanFFTPlan::InverseInPlace(float* Re, float* Im, float* Work, bool bSIMD) const
+{
+    check(IsValid());
+
+    if (Algorithm == EAlgorithm::MixedRadix)
+    {
+        InverseMixedRadix(Re, Im, Work);
+        return;
+    }
+    if (Algorithm == EAlgorithm::Bluestein)
+    {
+        InverseBluestein(Re, Im, Work, bSIMD);
+        return;
+    }
+
+    // 1. 位反转重排
+    for (int32 i = 0; i < Size; i++)
+    {
+        const int32 j = BitReverse[i];
+        if (i < j)
+        {
+            Swap(Re[i], Re[j]);
+            Swap(Im[i], Im[j]);
+        }
+    }
+
+    // 2. Cooley-Tukey 蝶形运算 (按时间抽取)
+    if (bSIMD)
+    {
+        ButterfliesSIMD(Re, Im);
+    }
+    else
+    {
+        ButterfliesScalar(Re, Im);
+    }
+}
+
+void FOceanFFTPlan::ButterfliesScalar(float* Re, float* Im) const
+{
+    for (int32 Len = 2; Len <= Size; Len <<= 1)
+    {
+        const int32 Half = Len / 2;
+        OceanFFT::ButterflyStageScalar(Re, Im, Size, Len, TwiddleRe.GetData() + Half, TwiddleIm.GetData() + Half);
+    }
+}
+
+void FOceanFFTPlan::ButterfliesSIMD(float* Re, float* Im) const
+{
+    // 前两级 (L = 2, 4) 每块不足 4 个蝶形，仍然走标量
+    int32 Len = 2;
+    for (; Len <= Size && Len < 8; Len <<= 1)
+    {
+        const int32 Half = Len / 2;
+        OceanFFT::ButterflyStageScalar(Re, Im, Size, Len, TwiddleRe.GetData() + Half, TwiddleIm.GetData() + Half);
+    }
+
+    // 之后每次处理 4 个蝶形：SSE / AVX2 / NEON 由 VectorRegister4Float 自动选择
+    for (; Len <= Size; Len <<= 1)
+    {
+        const int32 Half = Len / 2;
+        const float* StageWRe = TwiddleRe.GetData() + Half;
+        const float* StageWIm = TwiddleIm.GetData() + Half;
+
+        for (int32 Start = 0; Start < Size; Start += Len)
+        {
+            float* ARe = Re + Start;
+            float* AIm = Im + Start;
+            float* BRe = ARe + Half;
+            float* BIm = AIm + Half;
+
+            for (int32 j = 0; j < Half; j += 4)
+            {
+                const VectorRegister4Float WRe = VectorLoadAligned(StageWRe + j);
+                const VectorRegister4Float WIm = VectorLoadAligned(StageWIm + j);
+                const VectorRegister4Float VBRe = VectorLoad(BRe + j);
+                const VectorRegister4Float VBIm = VectorLoad(BIm + j);
+                const VectorRegister4Float VARe = VectorLoad(ARe + j);
+                const VectorRegister4Float VAIm = VectorLoad(AIm + j);
+
+                // T = W * B
+                const VectorRegister4Float TRe = VectorNegateMultiplyAdd(WIm, VBIm, VectorMultiply(WRe, VBRe));
+                const VectorRegister4Float TIm = VectorMultiplyAdd(WRe, VBIm, VectorMultiply(WIm, VBRe));
+
+                VectorStore(VectorSubtract(VARe, TRe), BRe + j);
+                VectorStore(VectorSubtract(VAIm, TIm), BIm + j);
+                VectorStore(VectorAdd(VARe, TRe), ARe + j);
+                VectorStore(VectorAdd(VAIm, TIm), AIm + j);
+            }
+        }
+    }
+}
+
+void FOceanFFTPlan::InverseMixedRadix(float* Re, float* Im, float* Work) const
+{
+    check(Work);
+
+    // 在输入数组和 Work 之间来回倒 (乒乓)，每一级读一个写另一个
+    float* SrcRe = Re;
+    float* SrcIm = Im;
+    float* DstRe = Work;
+    float* DstIm = Work + Size;
+
+    for (const FStage& Stage : Stages)
+    {
+        const float* TwRe = TwiddleRe.GetData() + Stage.TwiddleOffset;
+        const float* TwIm = TwiddleIm.GetData() + Stage.TwiddleOffset;
+
+        switch (Stage.Radix)
+        {
+        case 2: OceanFFT::StockhamStage<2>(SrcRe, SrcIm, DstRe, DstIm, Stage.SubLength, Stage.Stride, TwRe, TwIm); break;
+        case 3: OceanFFT::StockhamStage<3>(SrcRe, SrcIm, DstRe, DstIm, Stage.SubLength, Stage.Stride, TwRe, TwIm); break;
+        case 4: OceanFFT::StockhamStage<4>(SrcRe, SrcIm, DstRe, DstIm, Stage.SubLength, Stage.Stride, TwRe, TwIm); break;
+        case 5: OceanFFT::StockhamStage<5>(SrcRe, SrcIm, DstRe, DstIm, Stage.SubLength, Stage.Stride, TwRe, TwIm); break;
+        default: checkNoEntry(); break;
+        }
+
+        Swap(SrcRe, DstRe);
+        Swap(SrcIm, DstIm);
+    }
+
+    // 级数为奇数时结果在 Work 里，拷回去
+    if (SrcRe != Re)
+    {
+        FMemory::Memcpy(Re, SrcRe, Size * sizeof(float));
+        FMemory::Memcpy(Im, SrcIm, Size * sizeof(float));
+    }
+}
+
+void FOceanFFTPlan::InverseBluestein(float* Re, float* Im, float* Work, bool bSIMD) const
+{
+    check(Work);
+    float* ARe = Work;
+    float* AIm = Work + BluesteinSize;
+
+    // 1. a[n] = x[n] * w[n]，后面补零
+    for (int32 n = 0; n < Size; n++)
+    {
+        ARe[n] = Re[n] * ChirpRe[n] - Im[n] * ChirpIm[n];
+        AIm[n] = Re[n] * ChirpIm[n] + Im[n] * ChirpRe[n];
+    }
+    FMemory::Memzero(ARe + Size, (BluesteinSize - Size) * sizeof(float));
+    FMemory::Memzero(AIm + Size, (BluesteinSize - Size) * sizeof(float));
+
+    // 2. 卷积定理：变换 -> 与卷积核逐点相乘 -> 反方向变换
+    BluesteinPlan->InverseInPlace(ARe, AIm, nullptr, bSIMD);
+
+    for (int32 m = 0; m < BluesteinSize; m++)
+    {
+        const float TRe = ARe[m] * KernelRe[m] - AIm[m] * KernelIm[m];
+        const float TIm = ARe[m] * KernelIm[m] + AIm[m] * KernelRe[m];
+        ARe[m] = TRe;
+        AIm[m] = -TIm; // 先取共轭：正向变换 = conj(逆变换(conj(x)))
+    }
+
+    BluesteinPlan->InverseInPlace(ARe, AIm, nullptr, bSIMD);
+
+    // 3. X[k] = w[k] * conj(结果) (第二次共轭在这里完成)
+    for (int32 k = 0; k < Size; k++)
+    {
+        const float CRe = ARe[k];
+        const float CIm = -AIm[k];
+        Re[k] = CRe * ChirpRe[k] - CIm * ChirpIm[k];
+        Im[k] = CRe * ChirpIm[k] + CIm * ChirpRe[k];
+    }
+}
+
+void FOceanFFTPlan::Inverse2D(float* Re, float* Im, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    Inverse2DRows(Re, Im, 0, Size, Scratch, Parallel);
+    Inverse2DColumns(Re, Im, 0, Size, Scratch, Parallel);
+}
+
+void FOceanFFTPlan::Inverse2DRows(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    check(IsValid() && Begin >= 0 && End <= Size);
+    if (Begin >= End) return;
+    const bool bSIMD = UseSIMD();
+
+    // 每个任务块一份 1D 变换自己的 Work
+    const int32 ChunkScratchSize = OceanFFT::AlignChunkSize(GetWorkSize());
+    const int32 NumChunks = OceanFFT::GetNumChunks(End - Begin, Parallel);
+    Scratch.SetNumUninitialized(FMath::Max(Scratch.Num(), NumChunks * ChunkScratchSize), EAllowShrinking::No);
+
+    // 行变换：每一行在内存中连续，直接原地做
+    SCOPE_CYCLE_COUNTER(STAT_OceanFFT2DRows);
+    OceanFFT::ParallelForChunks(End - Begin, NumChunks, [&](int32 Chunk, int32 ChunkBegin, int32 ChunkEnd)
+    {
+        float* Work = Scratch.GetData() + Chunk * ChunkScratchSize;
+        for (int32 Row = Begin + ChunkBegin; Row < Begin + ChunkEnd; Row++)
+        {
+            InverseInPlace(Re + Row * Size, Im + Row * Size, Work, bSIMD);
+        }
+    });
+}
+
+void FOceanFFTPlan::Inverse2DColumns(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    check(IsValid() && Begin >= 0 && End <= Size);
+    if (Begin >= End) return;
+    const bool bSIMD = UseSIMD();
+
+    // 每个任务块一份缓冲：一列的实部 + 虚部，再加上 1D 变换自己的 Work
+    const int32 ChunkScratchSize = OceanFFT::AlignChunkSize(2 * Size + GetWorkSize());
+    const int32 NumChunks = OceanFFT::GetNumChunks(End - Begin, Parallel);
+    Scratch.SetNumUninitialized(FMath::Max(Scratch.Num(), NumChunks * ChunkScratchSize), EAllowShrinking::No);
+
+    // 列变换：先把一列拷到连续的临时缓冲，做完再写回
+    SCOPE_CYCLE_COUNTER(STAT_OceanFFT2DColumns);
+    OceanFFT::ParallelForChunks(End - Begin, NumChunks, [&](int32 Chunk, int32 ChunkBegin, int32 ChunkEnd)
+    {
+        float* ColRe = Scratch.GetData() + Chunk * ChunkScratchSize;
+        float* ColIm = ColRe + Size;
+        float* Work = ColIm + Size;
+        for (int32 Col = Begin + ChunkBegin; Col < Begin + ChunkEnd; Col++)
+        {
+            for (int32 Row = 0; Row < Size; Row++)
+            {
+                ColRe[Row] = Re[Row * Size + Col];
+                ColIm[Row] = Im[Row * Size + Col];
+            }
+
+            InverseInPlace(ColRe, ColIm, Work, bSIMD);
+
+            for (int32 Row = 0; Row < Size; Row++)
+            {
+                Re[Row * Size + Col] = ColRe[Row];
+                Im[Row * Size + Col] = ColIm[Row];
+            }
+        }
+    });
+}
+
+
+FOceanRealFFTPlan::FOceanRealFFTPlan(int32 InSize)
+{
+    Initialize(InSize);
+}
+
+bool FOceanRealFFTPlan::IsSupportedSize(int32 InSize)
+{
+    return InSize >= 2;
+}
+
+void FOceanRealFFTPlan::Initialize(int32 InSize)
+{
+    Size = 0;
+    SplitTwiddleRe.Reset();
+    SplitTwiddleIm.Reset();
+
+    if (!IsSupportedSize(InSize))
+    {
+        UE_LOG(LogTemp, Error, TEXT("FOceanRealFFTPlan: unsupported size %d (must be >= 2)."), InSize);
+        return;
+    }
+
+    Size = InSize;
+    FullPlan.Initialize(Size);
+
+    if (Size % 2 != 0)
+    {
+        HalfPlan = FOceanFFTPlan();
+        return;
+    }
+
+    HalfPlan.Initialize(Size / 2);
+
+    const int32 HalfLen = Size / 2;
+    SplitTwiddleRe.SetNumUninitialized(HalfLen);
+    SplitTwiddleIm.SetNumUninitialized(HalfLen);
+    for (int32 k = 0; k < HalfLen; k++)
+    {
+        const double Angle = 2.0 * UE_DOUBLE_PI * k / Size;
+        SplitTwiddleRe[k] = (float)FMath::Cos(Angle);
+        SplitTwiddleIm[k] = (float)FMath::Sin(Angle);
+    }
+}
+
+int32 FOceanRealFFTPlan::GetRowWorkSize() const
+{
+    // 偶数：N/2 个复数 + 半长计划的 Work；奇数：N 个复数 + 全长计划的 Work
+    return (Size % 2 == 0)
+        ? Size + HalfPlan.GetWorkSize()
+        : 2 * Size + FullPlan.GetWorkSize();
+}
+
+void FOceanRealFFTPlan::InverseRow(const float* InRe, const float* InIm, float* Out, float* Work) const
+{
+    check(IsValid());
+
+    // N 为奇数：按共轭对称补全整行，做一次长度 N 的复数变换，取实部
+    if (Size % 2 != 0)
+    {
+        float* RowRe = Work;
+        float* RowIm = Work + Size;
+        const int32 HalfSize = GetHalfSize();
+        for (int32 k = 0; k < HalfSize; k++)
+        {
+            RowRe[k] = InRe[k];
+            RowIm[k] = InIm[k];
+        }
+        for (int32 k = HalfSize; k < Size; k++)
+        {
+            RowRe[k] = InRe[Size - k];
+            RowIm[k] = -InIm[Size - k];
+        }
+
+        FullPlan.InverseInPlace(RowRe, RowIm, RowIm + Size);
+        FMemory::Memcpy(Out, RowRe, Size * sizeof(float));
+        return;
+    }
+
+    const int32 HalfLen = Size / 2;
+    float* ScratchRe = Work;
+    float* ScratchIm = Work + HalfLen;
+
+    // 把 N 点实数输出拆成偶数点和奇数点两个序列，打包成一个 N/2 点复数序列：
+    // Even[k] = X[k] + X[k+N/2]，Odd[k] = (X[k] - X[k+N/2]) * e^(i*2*PI*k/N)
+    // 其中 X[k+N/2] = conj(X[N/2-k]) 由共轭对称得到
+    for (int32 k = 0; k < HalfLen; k++)
+    {
+        const float ARe = InRe[k];
+        const float AIm = InIm[k];
+        const float BRe = InRe[HalfLen - k];
+        const float BIm = -InIm[HalfLen - k];
+
+        const float EvenRe = ARe + BRe;
+        const float EvenIm = AIm + BIm;
+        const float DiffRe = ARe - BRe;
+        const float DiffIm = AIm - BIm;
+        const float OddRe = DiffRe * SplitTwiddleRe[k] - DiffIm * SplitTwiddleIm[k];
+        const float OddIm = DiffRe * SplitTwiddleIm[k] + DiffIm * SplitTwiddleRe[k];
+
+        // Even + i * Odd
+        ScratchRe[k] = EvenRe - OddIm;
+        ScratchIm[k] = EvenIm + OddRe;
+    }
+
+    HalfPlan.InverseInPlace(ScratchRe, ScratchIm, ScratchIm + HalfLen);
+
+    // 实部是偶数点，虚部是奇数点
+    for (int32 n = 0; n < HalfLen; n++)
+    {
+        Out[2 * n] = ScratchRe[n];
+        Out[2 * n + 1] = ScratchIm[n];
+    }
+}
+
+void FOceanRealFFTPlan::Inverse2D(float* Re, float* Im, float* Out, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    // 1. 列变换 (只有 N/2+1 列)
+    Inverse2DColumns(Re, Im, 0, GetHalfSize(), Scratch, Parallel);
+
+    // 2. 每一行仍然共轭对称，做 C2R 得到实数高度
+    Inverse2DRows(Re, Im, Out, 0, Size, Scratch, Parallel);
+}
+
+void FOceanRealFFTPlan::Inverse2DColumns(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    check(IsValid() && Begin >= 0 && End <= GetHalfSize());
+    if (Begin >= End) return;
+    const int32 HalfSize = GetHalfSize();
+    const bool bSIMD = FOceanFFTPlan::UseSIMD();
+
+    const int32 ChunkScratchSize = OceanFFT::AlignChunkSize(2 * Size + FullPlan.GetWorkSize());
+    const int32 NumChunks = OceanFFT::GetNumChunks(End - Begin, Parallel);
+    Scratch.SetNumUninitialized(FMath::Max(Scratch.Num(), NumChunks * ChunkScratchSize), EAllowShrinking::No);
+
+    SCOPE_CYCLE_COUNTER(STAT_OceanFFT2DColumns);
+    OceanFFT::ParallelForChunks(End - Begin, NumChunks, [&](int32 Chunk, int32 ChunkBegin, int32 ChunkEnd)
+    {
+        float* ColRe = Scratch.GetData() + Chunk * ChunkScratchSize;
+        float* ColIm = ColRe + Size;
+        float* Work = ColIm + Size;
+        for (int32 Col = Begin + ChunkBegin; Col < Begin + ChunkEnd; Col++)
+        {
+            for (int32 Row = 0; Row < Size; Row++)
+            {
+                ColRe[Row] = Re[Row * HalfSize + Col];
+                ColIm[Row] = Im[Row * HalfSize + Col];
+            }
+
+            FullPlan.InverseInPlace(ColRe, ColIm, Work, bSIMD);
+
+            for (int32 Row = 0; Row < Size; Row++)
+            {
+                Re[Row * HalfSize + Col] = ColRe[Row];
+                Im[Row * HalfSize + Col] = ColIm[Row];
+            }
+        }
+    });
+}
+
+void FOceanRealFFTPlan::Inverse2DRows(const float* Re, const float* Im, float* Out, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel) const
+{
+    check(IsValid() && Begin >= 0 && End <= Size);
+    if (Begin >= End) return;
+    const int32 HalfSize = GetHalfSize();
+
+    const int32 ChunkScratchSize = OceanFFT::AlignChunkSize(GetRowWorkSize());
+    const int32 NumChunks = OceanFFT::GetNumChunks(End - Begin, Parallel);
+    Scratch.SetNumUninitialized(FMath::Max(Scratch.Num(), NumChunks * ChunkScratchSize), EAllowShrinking::No);
+
+    SCOPE_CYCLE_COUNTER(STAT_OceanFFT2DRows);
+    OceanFFT::ParallelForChunks(End - Begin, NumChunks, [&](int32 Chunk, int32 ChunkBegin, int32 ChunkEnd)
+    {
+        float* Work = Scratch.GetData() + Chunk * ChunkScratchSize;
+        for (int32 Row = Begin + ChunkBegin; Row < Begin + ChunkEnd; Row++)
+        {
+            InverseRow(Re + Row * HalfSize, Im + Row * HalfSize, Out + Row * Size, Work);
+        }
+    });
+}
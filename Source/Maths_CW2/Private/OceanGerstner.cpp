@@ -0,0 +1,575 @@
+#include "OceanGerstner.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Math/VectorRegister.h"
+
+static TAutoConsoleVariable<int32> CVarOceanGerstnerSIMD(
+    TEXT("ocean.Gerstner.SIMD"),
+    1,
+    TEXT("Use the VectorRegister4Float kernel for Gerstner waves.\n")
+    TEXT("0 = scalar reference path, 1 = SIMD (default)."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarOceanGerstnerRecurrence(
+    TEXT("ocean.Gerstner.Recurrence"),
+    1,
+    TEXT("Advance Gerstner phases along each grid row with a complex rotation instead of sin/cos per vertex.\n")
+    TEXT("0 = sin/cos per vertex and wave, 1 = phase recurrence (default)."),
+    ECVF_Default);
+
+namespace OceanGerstner
+{
+    // 递推多少步把 (sin, cos) 拉回单位圆一次
+    static constexpr int32 RenormalizeInterval = 16;
+
+    // 每个波在临时缓冲里占的 float 个数：4 个通道的 sin、4 个通道的 cos、每步的旋转 (sin, cos)，补齐到 16 字节
+    static constexpr int32 ScratchPerWave = 12;
+
+    // --- 标量 ---
+
+    struct FAccumulator
+    {
+        float PosX, PosY, PosZ;
+        float SlopeX = 0.0f, SlopeY = 0.0f;               // Σ D*A*k*cos
+        float CurlXX = 0.0f, CurlYY = 0.0f, CurlXY = 0.0f; // Σ D*D*Q*A*k*sin
+
+        FAccumulator(float BaseX, float BaseY) : PosX(BaseX), PosY(BaseY), PosZ(0.0f) {}
+    };
+
+    // 一个波对一个顶点的贡献 (sin / cos 已经求好)
+    static FORCEINLINE void AccumulateWave(FAccumulator& Acc, const FOceanGerstnerWaves& Waves, int32 w, float SinVal, float CosVal)
+    {
+        // Z 轴位移 (高度)
+        Acc.PosZ += Waves.Amplitude[w] * SinVal;
+
+        // --- [关键修复 1] 形状修复 ---
+        // 之前的公式 (Steepness/k) * Amplitude 导致了单位平方级的爆炸
+        // 现在改为直接用 steepness 作为 0~1 的系数
+        // 只要 Steepness * Amplitude < Wavelength / 2PI，就不会打结
+        // 这里我们简单粗暴地用乘法，保证不炸
+        const float HorizontalOffset = Waves.Steepness[w] * Waves.Amplitude[w] * CosVal;
+
+        Acc.PosX -= Waves.DirX[w] * HorizontalOffset;
+        Acc.PosY -= Waves.DirY[w] * HorizontalOffset;
+
+        // 偏导数 (与位移用同一组 sin / cos)
+        const float WA = Waves.Amplitude[w] * Waves.K[w];
+        const float QWASin = Waves.Steepness[w] * WA * SinVal;
+        Acc.SlopeX += Waves.DirX[w] * WA * CosVal;
+        Acc.SlopeY += Waves.DirY[w] * WA * CosVal;
+        Acc.CurlXX += Waves.DirX[w] * Waves.DirX[w] * QWASin;
+        Acc.CurlYY += Waves.DirY[w] * Waves.DirY[w] * QWASin;
+        Acc.CurlXY += Waves.DirX[w] * Waves.DirY[w] * QWASin;
+    }
+
+    static FORCEINLINE void StoreVertex(const FAccumulator& Acc, FVector3f& OutPosition, FOceanMeshTangent& OutTangent)
+    {
+        OutPosition = FVector3f(Acc.PosX, Acc.PosY, Acc.PosZ);
+
+        // 法线 = dP/dx x dP/dy (平面时为 (0,0,1)，朝上)
+        FVector3f TangentX(1.0f + Acc.CurlXX, Acc.CurlXY, Acc.SlopeX);
+        FVector3f TangentY(Acc.CurlXY, 1.0f + Acc.CurlYY, Acc.SlopeY);
+        FVector3f NewNormal = FVector3f::CrossProduct(TangentX, TangentY).GetSafeNormal();
+        OutTangent = UOceanMeshComponent::MakeTangent(NewNormal);
+    }
+
+    // --- SIMD (4 个相邻顶点放在一个寄存器的 4 个通道里) ---
+
+    struct FAccumulator4
+    {
+        VectorRegister4Float PosX, PosY, PosZ;
+        VectorRegister4Float SlopeX, SlopeY;
+        VectorRegister4Float CurlXX, CurlYY, CurlXY;
+
+        FAccumulator4(const VectorRegister4Float& BaseX, const VectorRegister4Float& BaseY)
+            : PosX(BaseX), PosY(BaseY), PosZ(VectorZeroFloat())
+            , SlopeX(VectorZeroFloat()), SlopeY(VectorZeroFloat())
+            , CurlXX(VectorZeroFloat()), CurlYY(VectorZeroFloat()), CurlXY(VectorZeroFloat())
+        {
+        }
+    };
+
+    // 同一个波的参数广播到 4 个通道
+    static FORCEINLINE void AccumulateWave4(FAccumulator4& Acc, const FOceanGerstnerWaves& Waves, int32 w, const VectorRegister4Float& SinVal, const VectorRegister4Float& CosVal)
+    {
+        const float WA = Waves.Amplitude[w] * Waves.K[w];
+        const float QWA = Waves.Steepness[w] * WA;
+        const VectorRegister4Float DirX = VectorSetFloat1(Waves.DirX[w]);
+        const VectorRegister4Float DirY = VectorSetFloat1(Waves.DirY[w]);
+
+        // 高度 A*sin，水平 -D*Q*A*cos
+        Acc.PosZ = VectorMultiplyAdd(VectorSetFloat1(Waves.Amplitude[w]), SinVal, Acc.PosZ);
+        const VectorRegister4Float HorizontalOffset = VectorMultiply(VectorSetFloat1(Waves.Steepness[w] * Waves.Amplitude[w]), CosVal);
+        Acc.PosX = VectorNegateMultiplyAdd(DirX, HorizontalOffset, Acc.PosX);
+        Acc.PosY = VectorNegateMultiplyAdd(DirY, HorizontalOffset, Acc.PosY);
+
+        // 偏导数
+        const VectorRegister4Float WACos = VectorMultiply(VectorSetFloat1(WA), CosVal);
+        const VectorRegister4Float QWASin = VectorMultiply(VectorSetFloat1(QWA), SinVal);
+        Acc.SlopeX = VectorMultiplyAdd(DirX, WACos, Acc.SlopeX);
+        Acc.SlopeY = VectorMultiplyAdd(DirY, WACos, Acc.SlopeY);
+        Acc.CurlXX = VectorMultiplyAdd(VectorSetFloat1(Waves.DirX[w] * Waves.DirX[w]), QWASin, Acc.CurlXX);
+        Acc.CurlYY = VectorMultiplyAdd(VectorSetFloat1(Waves.DirY[w] * Waves.DirY[w]), QWASin, Acc.CurlYY);
+        Acc.CurlXY = VectorMultiplyAdd(VectorSetFloat1(Waves.DirX[w] * Waves.DirY[w]), QWASin, Acc.CurlXY);
+    }
+
+    static FORCEINLINE void StoreVertices4(const FAccumulator4& Acc, FVector3f* OutPositions, FOceanMeshTangent* OutTangents)
+    {
+        // 法线 = (1+Cxx, Cxy, Sx) x (Cxy, 1+Cyy, Sy)，4 个通道一起归一化
+        const VectorRegister4Float One = VectorSetFloat1(1.0f);
+        const VectorRegister4Float TXX = VectorAdd(One, Acc.CurlXX);
+        const VectorRegister4Float TYY = VectorAdd(One, Acc.CurlYY);
+        const VectorRegister4Float NX = VectorNegateMultiplyAdd(Acc.SlopeX, TYY, VectorMultiply(Acc.CurlXY, Acc.SlopeY));
+        const VectorRegister4Float NY = VectorNegateMultiplyAdd(TXX, Acc.SlopeY, VectorMultiply(Acc.SlopeX, Acc.CurlXY));
+        const VectorRegister4Float NZ = VectorNegateMultiplyAdd(Acc.CurlXY, Acc.CurlXY, VectorMultiply(TXX, TYY));
+        const VectorRegister4Float LengthSquared = VectorMultiplyAdd(NX, NX, VectorMultiplyAdd(NY, NY, VectorMultiply(NZ, NZ)));
+        const VectorRegister4Float InvLength = VectorReciprocalSqrt(VectorMax(LengthSquared, VectorSetFloat1(1.e-16f)));
+
+        alignas(16) float OutX[4], OutY[4], OutZ[4], OutNX[4], OutNY[4], OutNZ[4];
+        VectorStoreAligned(Acc.PosX, OutX);
+        VectorStoreAligned(Acc.PosY, OutY);
+        VectorStoreAligned(Acc.PosZ, OutZ);
+        VectorStoreAligned(VectorMultiply(NX, InvLength), OutNX);
+        VectorStoreAligned(VectorMultiply(NY, InvLength), OutNY);
+        VectorStoreAligned(VectorMultiply(NZ, InvLength), OutNZ);
+
+        // 切线打包成 GPU 格式 (FPackedNormal) 只能逐个做
+        for (int32 Lane = 0; Lane < 4; Lane++)
+        {
+            OutPositions[Lane] = FVector3f(OutX[Lane], OutY[Lane], OutZ[Lane]);
+            OutTangents[Lane] = UOceanMeshComponent::MakeTangent(FVector3f(OutNX[Lane], OutNY[Lane], OutNZ[Lane]));
+        }
+    }
+}
+
+
+bool OceanGerstner::UseSIMD()
+{
+    return CVarOceanGerstnerSIMD.GetValueOnAnyThread() != 0;
+}
+
+
+bool OceanGerstner::UseRecurrence()
+{
+    return CVarOceanGerstnerRecurrence.GetValueOnAnyThread() != 0;
+}
+
+
+int32 OceanGerstner::GetRowScratchSize(int32 NumWaves)
+{
+    return FMath::Max(NumWaves, 1) * ScratchPerWave;
+}
+
+
+void OceanGerstner::EvaluateRow(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch)
+{
+    const bool bSIMD = UseSIMD();
+    if (Scratch && UseRecurrence())
+    {
+        if (bSIMD)
+        {
+            EvaluateRowRecurrenceSIMD(Waves, X0, StepX, Y, Count, OutPositions, OutTangents, Scratch);
+        }
+        else
+        {
+            EvaluateRowRecurrenceScalar(Waves, X0, StepX, Y, Count, OutPositions, OutTangents, Scratch);
+        }
+    }
+    else if (bSIMD)
+    {
+        EvaluateRowSIMD(Waves, X0, StepX, Y, Count, OutPositions, OutTangents);
+    }
+    else
+    {
+        EvaluateRowScalar(Waves, X0, StepX, Y, Count, OutPositions, OutTangents);
+    }
+}
+
+
+// 位移后的位置 P(x, y) = (x - Σ Dx*Q*A*cos, y - Σ Dy*Q*A*cos, Σ A*sin)，θ = k*(D·x - c*t)，对基础位置求偏导：
+//   dP/dx = (1 + Σ Dx*Dx*Q*A*k*sin,     Σ Dx*Dy*Q*A*k*sin, Σ Dx*A*k*cos)
+//   dP/dy = (    Σ Dx*Dy*Q*A*k*sin, 1 + Σ Dy*Dy*Q*A*k*sin, Σ Dy*A*k*cos)
+// 法线 = dP/dx x dP/dy，和顶点在同一个循环里累加，不需要读邻居顶点，边缘也不用特殊处理
+void OceanGerstner::EvaluateRowScalar(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents)
+{
+    for (int32 n = 0; n < Count; n++)
+    {
+        // 基础位置
+        const float BaseX = X0 + n * StepX;
+        FAccumulator Acc(BaseX, Y);
+
+        for (int32 w = 0; w < Waves.Num; w++)
+        {
+            // θ = k*(D·x) - k*c*t
+            const float Theta = Waves.K[w] * (Waves.DirX[w] * BaseX + Waves.DirY[w] * Y) - Waves.Phase[w];
+
+            float SinVal, CosVal;
+            FMath::SinCos(&SinVal, &CosVal, Theta);
+            AccumulateWave(Acc, Waves, w, SinVal, CosVal);
+        }
+
+        StoreVertex(Acc, OutPositions[n], OutTangents[n]);
+    }
+}
+
+
+void OceanGerstner::EvaluateRowSIMD(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents)
+{
+    // 公式同标量版本 (SSE / AVX2 / NEON 由 VectorRegister4Float 自动选择)，每个波只做一次 4 路的 VectorSinCos
+    const VectorRegister4Float LaneOffset = MakeVectorRegisterFloat(0.0f, 1.0f, 2.0f, 3.0f);
+    const VectorRegister4Float VStepX = VectorSetFloat1(StepX);
+    const VectorRegister4Float VX0 = VectorSetFloat1(X0);
+    const VectorRegister4Float VY = VectorSetFloat1(Y);
+
+    int32 n = 0;
+    for (; n + 4 <= Count; n += 4)
+    {
+        const VectorRegister4Float BaseX = VectorMultiplyAdd(VectorAdd(VectorSetFloat1((float)n), LaneOffset), VStepX, VX0);
+        FAccumulator4 Acc(BaseX, VY);
+
+        for (int32 w = 0; w < Waves.Num; w++)
+        {
+            // θ = k*(Dx*x + Dy*y) - k*c*t
+            const VectorRegister4Float Dot = VectorMultiplyAdd(VectorSetFloat1(Waves.DirX[w]), BaseX, VectorSetFloat1(Waves.DirY[w] * Y));
+            const VectorRegister4Float Theta = VectorSubtract(VectorMultiply(VectorSetFloat1(Waves.K[w]), Dot), VectorSetFloat1(Waves.Phase[w]));
+
+            VectorRegister4Float SinVal, CosVal;
+            VectorSinCos(&SinVal, &CosVal, &Theta);
+            AccumulateWave4(Acc, Waves, w, SinVal, CosVal);
+        }
+
+        StoreVertices4(Acc, OutPositions + n, OutTangents + n);
+    }
+
+    // 剩下不足 4 个顶点
+    if (n < Count)
+    {
+        EvaluateRowScalar(Waves, X0 + n * StepX, StepX, Y, Count - n, OutPositions + n, OutTangents + n);
+    }
+}
+
+
+void OceanGerstner::EvaluateRowRecurrenceScalar(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch)
+{
+    // 1. 行首：每个波求一次当前的 (sin, cos) 和每一步的旋转 (sin, cos)
+    for (int32 w = 0; w < Waves.Num; w++)
+    {
+        float* State = Scratch + w * ScratchPerWave;
+        const float Theta = Waves.K[w] * (Waves.DirX[w] * X0 + Waves.DirY[w] * Y) - Waves.Phase[w];
+        FMath::SinCos(&State[0], &State[1], Theta);
+        FMath::SinCos(&State[2], &State[3], Waves.K[w] * Waves.DirX[w] * StepX);
+    }
+
+    // 2. 沿着行走：sin(θ+Δ) = sin*cosΔ + cos*sinΔ，cos(θ+Δ) = cos*cosΔ - sin*sinΔ
+    for (int32 n = 0; n < Count; n++)
+    {
+        FAccumulator Acc(X0 + n * StepX, Y);
+        const bool bRenormalize = (n % RenormalizeInterval) == RenormalizeInterval - 1;
+
+        for (int32 w = 0; w < Waves.Num; w++)
+        {
+            float* State = Scratch + w * ScratchPerWave;
+            const float SinVal = State[0];
+            const float CosVal = State[1];
+            AccumulateWave(Acc, Waves, w, SinVal, CosVal);
+
+            float NextSin = SinVal * State[3] + CosVal * State[2];
+            float NextCos = CosVal * State[3] - SinVal * State[2];
+            if (bRenormalize)
+            {
+                // 1/sqrt(r^2) 在 r^2 = 1 附近的一阶近似：(3 - r^2) / 2
+                const float Scale = 1.5f - 0.5f * (NextSin * NextSin + NextCos * NextCos);
+                NextSin *= Scale;
+                NextCos *= Scale;
+            }
+            State[0] = NextSin;
+            State[1] = NextCos;
+        }
+
+        StoreVertex(Acc, OutPositions[n], OutTangents[n]);
+    }
+}
+
+
+void OceanGerstner::EvaluateRowRecurrenceSIMD(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch)
+{
+    // 4 个通道是相邻的 4 个顶点，每次前进 4 步：旋转角是 4 * k*Dx*StepX
+    const VectorRegister4Float LaneOffset = MakeVectorRegisterFloat(0.0f, 1.0f, 2.0f, 3.0f);
+    const VectorRegister4Float VStepX = VectorSetFloat1(StepX);
+    const VectorRegister4Float VX0 = VectorSetFloat1(X0);
+    const VectorRegister4Float VY = VectorSetFloat1(Y);
+    const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+    const VectorRegister4Float OneAndHalf = VectorSetFloat1(1.5f);
+
+    // 1. 行首：每个波一次 4 路 VectorSinCos 得到前 4 个顶点的 (sin, cos)，再加上每次前进的旋转
+    const VectorRegister4Float FirstX = VectorMultiplyAdd(LaneOffset, VStepX, VX0);
+    for (int32 w = 0; w < Waves.Num; w++)
+    {
+        float* State = Scratch + w * ScratchPerWave;
+        const VectorRegister4Float Dot = VectorMultiplyAdd(VectorSetFloat1(Waves.DirX[w]), FirstX, VectorSetFloat1(Waves.DirY[w] * Y));
+        const VectorRegister4Float Theta = VectorSubtract(VectorMultiply(VectorSetFloat1(Waves.K[w]), Dot), VectorSetFloat1(Waves.Phase[w]));
+
+        VectorRegister4Float SinVal, CosVal;
+        VectorSinCos(&SinVal, &CosVal, &Theta);
+        VectorStoreAligned(SinVal, State);
+        VectorStoreAligned(CosVal, State + 4);
+        FMath::SinCos(&State[8], &State[9], 4.0f * Waves.K[w] * Waves.DirX[w] * StepX);
+    }
+
+    // 2. 沿着行走，每个波只剩一次 4 路的复数乘法
+    int32 n = 0;
+    for (int32 Group = 0; n + 4 <= Count; n += 4, Group++)
+    {
+        const VectorRegister4Float BaseX = VectorMultiplyAdd(VectorAdd(VectorSetFloat1((float)n), LaneOffset), VStepX, VX0);
+        FAccumulator4 Acc(BaseX, VY);
+        const bool bRenormalize = (Group % RenormalizeInterval) == RenormalizeInterval - 1;
+
+        for (int32 w = 0; w < Waves.Num; w++)
+        {
+            float* State = Scratch + w * ScratchPerWave;
+            const VectorRegister4Float SinVal = VectorLoadAligned(State);
+            const VectorRegister4Float CosVal = VectorLoadAligned(State + 4);
+            AccumulateWave4(Acc, Waves, w, SinVal, CosVal);
+
+            const VectorRegister4Float StepSin = VectorSetFloat1(State[8]);
+            const VectorRegister4Float StepCos = VectorSetFloat1(State[9]);
+            VectorRegister4Float NextSin = VectorMultiplyAdd(SinVal, StepCos, VectorMultiply(CosVal, StepSin));
+            VectorRegister4Float NextCos = VectorNegateMultiplyAdd(SinVal, StepSin, VectorMultiply(CosVal, StepCos));
+            if (bRenormalize)
+            {
+                // (3 - r^2) / 2
+                const VectorRegister4Float RadiusSquared = VectorMultiplyAdd(NextSin, NextSin, VectorMultiply(NextCos, NextCos));
+                const VectorRegister4Float Scale = VectorNegateMultiplyAdd(Half, RadiusSquared, OneAndHalf);
+                NextSin = VectorMultiply(NextSin, Scale);
+                NextCos = VectorMultiply(NextCos, Scale);
+            }
+            VectorStoreAligned(NextSin, State);
+            VectorStoreAligned(NextCos, State + 4);
+        }
+
+        StoreVertices4(Acc, OutPositions + n, OutTangents + n);
+    }
+
+    // 剩下不足 4 个顶点 (每行最多 3 个)，直接求 sin / cos
+    if (n < Count)
+    {
+        EvaluateRowScalar(Waves, X0 + n * StepX, StepX, Y, Count - n, OutPositions + n, OutTangents + n);
+    }
+}
+
+
+// ============================================================================
+// FFT 合成
+// ============================================================================
+
+void FOceanGerstnerSpectrum::Initialize(int32 InResolution, float InOceanSize)
+{
+    Resolution = FMath::Max(InResolution, 1);
+    OceanSize = InOceanSize;
+    Plan.Initialize(Resolution);
+
+    for (FOceanComplexArray& Field : Fields)
+    {
+        Field.SetNumUninitialized(Resolution * Resolution);
+    }
+}
+
+
+// 顶点上的值是 Σ a*cosθ + i * Σ b*sinθ，θ = kx*x + ky*y - φ
+// 拆成 e^(iθ) 和 e^(-iθ) 两项：a*cosθ + i*b*sinθ = (a+b)/2 * e^(iθ) + (a-b)/2 * e^(-iθ)
+// 所以 (ix, iy) 格子加 (a+b)/2 * e^(-iφ)，(-ix, -iy) 格子加 (a-b)/2 * e^(iφ)
+void FOceanGerstnerSpectrum::SplatWaves(const FOceanGerstnerWaves& Waves)
+{
+    const int32 N = Resolution;
+    for (FOceanComplexArray& Field : Fields)
+    {
+        FMemory::Memzero(Field.Re.GetData(), N * N * sizeof(float));
+        FMemory::Memzero(Field.Im.GetData(), N * N * sizeof(float));
+    }
+
+    const float FrequencyStep = 2.0f * PI / OceanSize;
+    for (int32 w = 0; w < Waves.Num; w++)
+    {
+        // 1. 波矢吸附到最近的格子
+        const int32 IX = FMath::RoundToInt(Waves.K[w] * Waves.DirX[w] / FrequencyStep);
+        const int32 IY = FMath::RoundToInt(Waves.K[w] * Waves.DirY[w] / FrequencyStep);
+        const float KX = IX * FrequencyStep;
+        const float KY = IY * FrequencyStep;
+        const float K = FMath::Sqrt(KX * KX + KY * KY);
+
+        // 波长超过 OceanSize 两倍的波会落到 (0, 0)：只剩一个常数偏移，方向保持原样
+        const float DX = (K > 0.0f) ? KX / K : Waves.DirX[w];
+        const float DY = (K > 0.0f) ? KY / K : Waves.DirY[w];
+
+        // 2. 和 AccumulateWave 相同的系数，cos 项放实部，sin 项放虚部
+        const float A = Waves.Amplitude[w];
+        const float QA = Waves.Steepness[w] * A;
+        const float CosWeight[4] = { -DX * QA, -DY * QA, DX * A * K, DY * A * K };
+        const float SinWeight[4] = { A, DX * DX * QA * K, DY * DY * QA * K, DX * DY * QA * K };
+
+        // 3. 两个格子 (N 为偶数时 Nyquist 的两项会落在同一个格子上，照样相加)
+        float SinPhase, CosPhase;
+        FMath::SinCos(&SinPhase, &CosPhase, Waves.Phase[w]);
+        const int32 Positive = ((IY % N + N) % N) * N + ((IX % N + N) % N);
+        const int32 Negative = ((-IY % N + N) % N) * N + ((-IX % N + N) % N);
+
+        for (int32 f = 0; f < 4; f++)
+        {
+            const float Plus = 0.5f * (CosWeight[f] + SinWeight[f]);
+            const float Minus = 0.5f * (CosWeight[f] - SinWeight[f]);
+
+            // e^(-iφ) = (cos φ, -sin φ)
+            Fields[f].Re[Positive] += Plus * CosPhase;
+            Fields[f].Im[Positive] -= Plus * SinPhase;
+            Fields[f].Re[Negative] += Minus * CosPhase;
+            Fields[f].Im[Negative] += Minus * SinPhase;
+        }
+    }
+}
+
+
+void FOceanGerstnerSpectrum::Evaluate(const FOceanGerstnerWaves& Waves, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, const FOceanFFTParallelSettings& Parallel)
+{
+    if (!IsValid()) return;
+
+    // 1. 放进频率网格，4 次 2D 逆变换
+    SplatWaves(Waves);
+    for (FOceanComplexArray& Field : Fields)
+    {
+        Plan.Inverse2D(Field.Re.GetData(), Field.Im.GetData(), Scratch, Parallel);
+    }
+
+    // 2. 逐行拼出位置和法线 (最后一行/列取第一行/列)
+    const int32 N = Resolution;
+    const int32 NumVerts = N + 1;
+    const float Step = OceanSize / N;
+
+    const int32 MaxThreads = (Parallel.NumThreads > 0) ? Parallel.NumThreads : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    const int32 NumChunks = FMath::Clamp(FMath::DivideAndRoundUp(NumVerts, FMath::Max(Parallel.MinBatchSize, 1)), 1, MaxThreads);
+    ParallelFor(NumChunks, [&](int32 Chunk)
+    {
+        const int32 RowBegin = (int32)((int64)NumVerts * Chunk / NumChunks);
+        const int32 RowEnd = (int32)((int64)NumVerts * (Chunk + 1) / NumChunks);
+        for (int32 m = RowBegin; m < RowEnd; m++)
+        {
+            const int32 Row = (m % N) * N;
+            for (int32 n = 0; n < NumVerts; n++)
+            {
+                const int32 Index = Row + n % N;
+
+                OceanGerstner::FAccumulator Acc(n * Step + Fields[0].Re[Index], m * Step + Fields[1].Re[Index]);
+                Acc.PosZ = Fields[0].Im[Index];
+                Acc.CurlXX = Fields[1].Im[Index];
+                Acc.SlopeX = Fields[2].Re[Index];
+                Acc.CurlYY = Fields[2].Im[Index];
+                Acc.SlopeY = Fields[3].Re[Index];
+                Acc.CurlXY = Fields[3].Im[Index];
+
+                OceanGerstner::StoreVertex(Acc, OutPositions[m * NumVerts + n], OutTangents[m * NumVerts + n]);
+            }
+        }
+    }, NumChunks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+
+// ============================================================================
+// 基准测试：逐顶点求值 vs FFT 合成，找出波数的交叉点
+// ============================================================================
+
+// ocean.Gerstner.Benchmark [Resolution=128] [MaxWaves=256]
+// 单线程，随机波浪，波数从 1 开始每次翻倍
+static void RunGerstnerBenchmark(const TArray<FString>& Args)
+{
+    const int32 Resolution = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 128, 4, 1024);
+    const int32 MaxWaves = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 256, 1, 4096);
+    const float OceanSize = 10000.0f;
+    const int32 NumVerts = Resolution + 1;
+    const float Step = OceanSize / Resolution;
+    const int32 NumIterations = 5;
+
+    // 1. 随机波浪 (固定种子，结果可复现)
+    FRandomStream Random(1234);
+    FOceanAlignedFloatArray K, DirX, DirY, Amplitude, Steepness, Phase;
+    for (int32 w = 0; w < MaxWaves; w++)
+    {
+        const float Wavelength = Random.FRandRange(2.0f * Step, OceanSize);
+        const float Angle = Random.FRandRange(0.0f, 2.0f * PI);
+        K.Add(2.0f * PI / Wavelength);
+        DirX.Add(FMath::Cos(Angle));
+        DirY.Add(FMath::Sin(Angle));
+        Amplitude.Add(Wavelength * 0.005f);
+        Steepness.Add(Random.FRandRange(0.0f, 0.2f));
+        Phase.Add(Random.FRandRange(0.0f, 2.0f * PI));
+    }
+
+    TArray<FVector3f> Positions;
+    TArray<FOceanMeshTangent> Tangents;
+    Positions.SetNumUninitialized(NumVerts * NumVerts);
+    Tangents.SetNumUninitialized(NumVerts * NumVerts);
+    FOceanAlignedFloatArray RowScratch;
+    RowScratch.SetNumUninitialized(OceanGerstner::GetRowScratchSize(MaxWaves));
+
+    FOceanGerstnerSpectrum Spectrum;
+    Spectrum.Initialize(Resolution, OceanSize);
+    FOceanFFTParallelSettings SingleThread;
+    SingleThread.NumThreads = 1;
+
+    UE_LOG(LogTemp, Log, TEXT("Gerstner benchmark: %d x %d vertices, best of %d runs, single thread (SIMD %d, recurrence %d)."),
+        NumVerts, NumVerts, NumIterations, OceanGerstner::UseSIMD() ? 1 : 0, OceanGerstner::UseRecurrence() ? 1 : 0);
+    UE_LOG(LogTemp, Log, TEXT("  Waves   Direct (ms)   FFT (ms)"));
+
+    // 2. 每个波数取几次里最快的一次
+    int32 Crossover = 0;
+    for (int32 NumWaves = 1; NumWaves <= MaxWaves; NumWaves *= 2)
+    {
+        FOceanGerstnerWaves Waves;
+        Waves.Num = NumWaves;
+        Waves.K = K.GetData();
+        Waves.DirX = DirX.GetData();
+        Waves.DirY = DirY.GetData();
+        Waves.Amplitude = Amplitude.GetData();
+        Waves.Steepness = Steepness.GetData();
+        Waves.Phase = Phase.GetData();
+
+        double DirectMs = DBL_MAX;
+        double SpectrumMs = DBL_MAX;
+        for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+        {
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 m = 0; m < NumVerts; m++)
+            {
+                OceanGerstner::EvaluateRow(Waves, 0.0f, Step, m * Step, NumVerts,
+                    Positions.GetData() + m * NumVerts, Tangents.GetData() + m * NumVerts, RowScratch.GetData());
+            }
+            DirectMs = FMath::Min(DirectMs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+            StartTime = FPlatformTime::Seconds();
+            Spectrum.Evaluate(Waves, Positions.GetData(), Tangents.GetData(), SingleThread);
+            SpectrumMs = FMath::Min(SpectrumMs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("  %5d   %11.3f   %8.3f"), NumWaves, DirectMs, SpectrumMs);
+        if (Crossover == 0 && SpectrumMs < DirectMs)
+        {
+            Crossover = NumWaves;
+        }
+    }
+
+    if (Crossover > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("FFT synthesis is faster from %d waves (set FFTSynthesisWaveCount around this value)."), Crossover);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Log, TEXT("FFT synthesis was not faster up to %d waves."), MaxWaves);
+    }
+}
+
+static FAutoConsoleCommand GOceanGerstnerBenchmarkCommand(
+    TEXT("ocean.Gerstner.Benchmark"),
+    TEXT("Times per-vertex Gerstner evaluation against FFT synthesis for 1, 2, 4, ... waves and logs the crossover.\n")
+    TEXT("Usage: ocean.Gerstner.Benchmark [Resolution=128] [MaxWaves=256]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&RunGerstnerBenchmark));
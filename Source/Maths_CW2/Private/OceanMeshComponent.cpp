@@ -0,0 +1,482 @@
+#include "OceanMeshComponent.h"
+#include "DynamicMeshBuilder.h"
+#include "Engine/Engine.h"
+#include "LocalVertexFactory.h"
+#include "MaterialDomain.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRenderProxy.h"
+#include "Misc/ScopeLock.h"
+#include "PrimitiveSceneProxy.h"
+#include "PrimitiveViewRelevance.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "SceneInterface.h"
+#include "SceneManagement.h"
+
+namespace OceanMesh
+{
+    // ==========================================
+    // 顶点缓冲：创建时上传初始数据，之后 (动态的) 每帧整块覆盖
+    // 带一个 SRV，LocalVertexFactory 的手动顶点读取 (Manual Vertex Fetch) 需要
+    // ==========================================
+    class FVertexStreamBuffer : public FVertexBuffer
+    {
+    public:
+        FVertexStreamBuffer(const TCHAR* InDebugName, uint32 InStride, EPixelFormat InFormat, bool bInDynamic)
+            : DebugName(InDebugName)
+            , Stride(InStride)
+            , Format(InFormat)
+            , bDynamic(bInDynamic)
+        {
+        }
+
+        // 初始数据 (InitRHI 上传之后就释放)
+        TArray<uint8> InitialData;
+        int32 NumVertices = 0;
+
+        FShaderResourceViewRHIRef SRV;
+
+        virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+        {
+            const uint32 Size = NumVertices * Stride;
+            const FRHIBufferCreateDesc CreateDesc =
+                FRHIBufferCreateDesc::CreateVertex(DebugName, Size)
+                .AddUsage((bDynamic ? EBufferUsageFlags::Dynamic : EBufferUsageFlags::Static) | EBufferUsageFlags::ShaderResource)
+                .SetInitialState(ERHIAccess::VertexOrIndexBuffer | ERHIAccess::SRVMask);
+            VertexBufferRHI = RHICmdList.CreateBuffer(CreateDesc);
+
+            if (InitialData.Num() == (int32)Size)
+            {
+                Upload(RHICmdList, InitialData.GetData());
+            }
+            InitialData.Empty();
+
+            SRV = RHICmdList.CreateShaderResourceView(VertexBufferRHI,
+                FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Typed).SetFormat(Format));
+        }
+
+        virtual void ReleaseRHI() override
+        {
+            SRV.SafeRelease();
+            FVertexBuffer::ReleaseRHI();
+        }
+
+        // 整块覆盖 (数据已经是 GPU 格式，直接 memcpy)
+        void Upload(FRHICommandListBase& RHICmdList, const void* Data)
+        {
+            const uint32 Size = NumVertices * Stride;
+            void* Dest = RHICmdList.LockBuffer(VertexBufferRHI, 0, Size, RLM_WriteOnly);
+            FMemory::Memcpy(Dest, Data, Size);
+            RHICmdList.UnlockBuffer(VertexBufferRHI);
+        }
+
+    private:
+        const TCHAR* DebugName;
+        uint32 Stride;
+        EPixelFormat Format;
+        bool bDynamic;
+    };
+
+    // ==========================================
+    // 共用的索引缓冲：同样尺寸、同样块数的网格 (不管是哪个 Actor) 只建一份
+    // ==========================================
+    typedef TSharedPtr<FDynamicMeshIndexBuffer32> FSharedIndexBuffer;
+
+    // 三角形索引：每块网格 (NumVertsX-1) x (NumVertsY-1) 个格子，每格两个三角形
+    void BuildGridIndices(int32 NumVertsX, int32 NumVertsY, int32 NumPatches, TArray<uint32>& OutIndices)
+    {
+        OutIndices.Reset((NumVertsX - 1) * (NumVertsY - 1) * 6 * NumPatches);
+        for (int32 Patch = 0; Patch < NumPatches; Patch++)
+        {
+            const uint32 PatchBase = Patch * NumVertsX * NumVertsY;
+            for (int32 m = 0; m < NumVertsY - 1; m++)
+            {
+                for (int32 n = 0; n < NumVertsX - 1; n++)
+                {
+                    // 与原来 GenerateGrid 的三角形顺序一致
+                    uint32 Current = PatchBase + m * NumVertsX + n;
+                    uint32 Right = Current + 1;
+                    uint32 Bottom = Current + NumVertsX;
+                    uint32 BottomRight = Bottom + 1;
+
+                    OutIndices.Add(Current);
+                    OutIndices.Add(Bottom);
+                    OutIndices.Add(Right);
+
+                    OutIndices.Add(Right);
+                    OutIndices.Add(Bottom);
+                    OutIndices.Add(BottomRight);
+                }
+            }
+        }
+    }
+
+    // PreparedIndices 不为空时直接移进新建的索引缓冲 (已经在后台生成好了)
+    FSharedIndexBuffer AcquireGridIndexBuffer(int32 NumVertsX, int32 NumVertsY, int32 NumPatches, TArray<uint32>&& PreparedIndices)
+    {
+        // 只保存弱引用，最后一个渲染代理销毁时索引缓冲随之释放
+        // CreateSceneProxy 不一定在游戏线程 (并行创建渲染状态)，查找和插入都要加锁
+        static FCriticalSection CacheLock;
+        static TMap<FIntVector, TWeakPtr<FDynamicMeshIndexBuffer32>> Cache;
+        FScopeLock Lock(&CacheLock);
+
+        const FIntVector Key(NumVertsX, NumVertsY, NumPatches);
+        if (TWeakPtr<FDynamicMeshIndexBuffer32>* Existing = Cache.Find(Key))
+        {
+            if (FSharedIndexBuffer Pinned = Existing->Pin())
+            {
+                return Pinned;
+            }
+        }
+
+        FDynamicMeshIndexBuffer32* Buffer = new FDynamicMeshIndexBuffer32();
+        if (PreparedIndices.Num() == (NumVertsX - 1) * (NumVertsY - 1) * 6 * NumPatches)
+        {
+            Buffer->Indices = MoveTemp(PreparedIndices);
+        }
+        else
+        {
+            BuildGridIndices(NumVertsX, NumVertsY, NumPatches, Buffer->Indices);
+        }
+        BeginInitResource(Buffer);
+
+        // 引用计数可能在任意线程归零，释放统一交给渲染线程
+        FSharedIndexBuffer Shared = MakeShareable(Buffer, [](FDynamicMeshIndexBuffer32* ToDelete)
+        {
+            ENQUEUE_RENDER_COMMAND(ReleaseOceanGridIndexBuffer)([ToDelete](FRHICommandListImmediate& RHICmdList)
+            {
+                ToDelete->ReleaseResource();
+                delete ToDelete;
+            });
+        });
+
+        Cache.Add(Key, Shared);
+        return Shared;
+    }
+}
+
+
+// ==========================================
+// 渲染代理
+// ==========================================
+class FOceanMeshSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+    FOceanMeshSceneProxy(const UOceanMeshComponent* Component, const FOceanMeshStreams* InitialStreams, const TArray<FVector2f>& UVs, OceanMesh::FSharedIndexBuffer InIndexBuffer)
+        : FPrimitiveSceneProxy(Component)
+        , MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetShaderPlatform()))
+        , VertexFactory(GetScene().GetFeatureLevel(), "FOceanMeshSceneProxy")
+        , PositionBuffer(TEXT("OceanMeshPositions"), sizeof(FVector3f), PF_R32_FLOAT, true)
+        , TangentBuffer(TEXT("OceanMeshTangents"), sizeof(FOceanMeshTangent), PF_R8G8B8A8_SNORM, true)
+        , UVBuffer(TEXT("OceanMeshUVs"), sizeof(FVector2f), PF_G32R32F, false)
+        , IndexBuffer(MoveTemp(InIndexBuffer))
+    {
+        NumVertices = UVs.Num();
+
+        Material = Component->GetMaterial(0);
+        if (!Material)
+        {
+            Material = UMaterial::GetDefaultMaterial(MD_Surface);
+        }
+
+        // 初始数据：最后一次提交的顶点流 (还没有提交过就是平面)
+        PositionBuffer.NumVertices = NumVertices;
+        TangentBuffer.NumVertices = NumVertices;
+        UVBuffer.NumVertices = NumVertices;
+
+        if (InitialStreams && InitialStreams->Num() == NumVertices)
+        {
+            PositionBuffer.InitialData.Append(reinterpret_cast<const uint8*>(InitialStreams->Positions.GetData()), NumVertices * sizeof(FVector3f));
+            TangentBuffer.InitialData.Append(reinterpret_cast<const uint8*>(InitialStreams->Tangents.GetData()), NumVertices * sizeof(FOceanMeshTangent));
+        }
+        UVBuffer.InitialData.Append(reinterpret_cast<const uint8*>(UVs.GetData()), NumVertices * sizeof(FVector2f));
+    }
+
+    virtual ~FOceanMeshSceneProxy()
+    {
+        VertexFactory.ReleaseResource();
+        PositionBuffer.ReleaseResource();
+        TangentBuffer.ReleaseResource();
+        UVBuffer.ReleaseResource();
+    }
+
+    virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override
+    {
+        PositionBuffer.InitResource(RHICmdList);
+        TangentBuffer.InitResource(RHICmdList);
+        UVBuffer.InitResource(RHICmdList);
+
+        FLocalVertexFactory::FDataType Data;
+        Data.PositionComponent = FVertexStreamComponent(&PositionBuffer, 0, sizeof(FVector3f), VET_Float3);
+        Data.PositionComponentSRV = PositionBuffer.SRV;
+        Data.TangentBasisComponents[0] = FVertexStreamComponent(&TangentBuffer, STRUCT_OFFSET(FOceanMeshTangent, TangentX), sizeof(FOceanMeshTangent), VET_PackedNormal);
+        Data.TangentBasisComponents[1] = FVertexStreamComponent(&TangentBuffer, STRUCT_OFFSET(FOceanMeshTangent, TangentZ), sizeof(FOceanMeshTangent), VET_PackedNormal);
+        Data.TangentsSRV = TangentBuffer.SRV;
+        Data.TextureCoordinates.Add(FVertexStreamComponent(&UVBuffer, 0, sizeof(FVector2f), VET_Float2));
+        Data.TextureCoordinatesSRV = UVBuffer.SRV;
+        Data.NumTexCoords = 1;
+        Data.LightMapCoordinateIndex = 0;
+        FColorVertexBuffer::BindDefaultColorVertexBuffer(&VertexFactory, Data, FColorVertexBuffer::NullBindStride::ZeroForDefaultBufferBind);
+
+        VertexFactory.SetData(RHICmdList, Data);
+        VertexFactory.InitResource(RHICmdList);
+    }
+
+    // 渲染线程：把新一帧的位置和切线写进常驻的动态缓冲
+    void UpdateStreams_RenderThread(FRHICommandListBase& RHICmdList, const FOceanMeshStreams& Streams)
+    {
+        check(IsInRenderingThread());
+        if (Streams.Num() != NumVertices) return;
+
+        PositionBuffer.Upload(RHICmdList, Streams.Positions.GetData());
+        TangentBuffer.Upload(RHICmdList, Streams.Tangents.GetData());
+    }
+
+    virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+    {
+        if (!IndexBuffer.IsValid() || IndexBuffer->Indices.Num() == 0) return;
+
+        const bool bWireframe = AllowDebugViewmodes() && ViewFamily.EngineShowFlags.Wireframe;
+
+        FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+        if (bWireframe && GEngine->WireframeMaterial)
+        {
+            FColoredMaterialRenderProxy* WireframeMaterialInstance = new FColoredMaterialRenderProxy(GEngine->WireframeMaterial->GetRenderProxy(), FLinearColor(0.0f, 0.5f, 1.0f));
+            Collector.RegisterOneFrameMaterialProxy(WireframeMaterialInstance);
+            MaterialProxy = WireframeMaterialInstance;
+        }
+
+        for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+        {
+            if (!(VisibilityMap & (1 << ViewIndex))) continue;
+
+            FMeshBatch& Mesh = Collector.AllocateMesh();
+            Mesh.bWireframe = bWireframe;
+            Mesh.VertexFactory = &VertexFactory;
+            Mesh.MaterialRenderProxy = MaterialProxy;
+            Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+            Mesh.Type = PT_TriangleList;
+            Mesh.DepthPriorityGroup = SDPG_World;
+            Mesh.bCanApplyViewModeOverrides = false;
+
+            FMeshBatchElement& BatchElement = Mesh.Elements[0];
+            BatchElement.IndexBuffer = IndexBuffer.Get();
+            BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+            BatchElement.FirstIndex = 0;
+            BatchElement.NumPrimitives = IndexBuffer->Indices.Num() / 3;
+            BatchElement.MinVertexIndex = 0;
+            BatchElement.MaxVertexIndex = NumVertices - 1;
+
+            Collector.AddMesh(ViewIndex, Mesh);
+        }
+    }
+
+    virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+    {
+        FPrimitiveViewRelevance Result;
+        Result.bDrawRelevance = IsShown(View);
+        Result.bShadowRelevance = IsShadowCast(View);
+        Result.bDynamicRelevance = true;
+        Result.bRenderInMainPass = ShouldRenderInMainPass();
+        Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+        Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+        MaterialRelevance.SetPrimitiveViewRelevance(Result);
+        return Result;
+    }
+
+    virtual bool CanBeOccluded() const override
+    {
+        return !MaterialRelevance.bDisableDepthTest;
+    }
+
+    virtual uint32 GetMemoryFootprint() const override
+    {
+        return sizeof(*this) + GetAllocatedSize();
+    }
+
+    virtual SIZE_T GetTypeHash() const override
+    {
+        static size_t UniquePointer;
+        return reinterpret_cast<size_t>(&UniquePointer);
+    }
+
+private:
+    FMaterialRelevance MaterialRelevance;
+
+    FLocalVertexFactory VertexFactory;
+    OceanMesh::FVertexStreamBuffer PositionBuffer;
+    OceanMesh::FVertexStreamBuffer TangentBuffer;
+    OceanMesh::FVertexStreamBuffer UVBuffer;
+    OceanMesh::FSharedIndexBuffer IndexBuffer;
+
+    UMaterialInterface* Material = nullptr;
+    int32 NumVertices = 0;
+};
+
+
+// ==========================================
+// 组件
+// ==========================================
+UOceanMeshComponent::UOceanMeshComponent(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+
+void UOceanMeshComponent::InitializeGrid(int32 InNumVertsX, int32 InNumVertsY, float InStep, int32 InNumPatches)
+{
+    InitializeGrid(BuildGridTopology(InNumVertsX, InNumVertsY, InStep, InNumPatches));
+}
+
+
+void UOceanMeshComponent::InitializeGrid(FOceanMeshGridTopology&& Topology)
+{
+    // 渲染线程可能还在读旧的暂存缓冲
+    FlushPendingStreams();
+
+    NumVertsX = Topology.NumVertsX;
+    NumVertsY = Topology.NumVertsY;
+    NumPatches = Topology.NumPatches;
+    GridStep = Topology.Step;
+    LocalBoundsOverride = FBox(ForceInit);
+
+    // 静态流和索引直接接过来，两份暂存缓冲都从平面网格开始
+    UVs = MoveTemp(Topology.UVs);
+    PreparedIndices = MoveTemp(Topology.Indices);
+    PendingStreams[1] = Topology.FlatStreams;
+    PendingStreams[0] = MoveTemp(Topology.FlatStreams);
+    PendingIndex = 0;
+    LastSubmittedIndex = INDEX_NONE;
+
+    // 分辨率变了，顶点缓冲和索引缓冲都要换：重建渲染代理
+    UpdateBounds();
+    MarkRenderStateDirty();
+}
+
+
+FOceanMeshGridTopology UOceanMeshComponent::BuildGridTopology(int32 InNumVertsX, int32 InNumVertsY, float InStep, int32 InNumPatches, bool bWithIndices)
+{
+    FOceanMeshGridTopology Topology;
+    Topology.NumVertsX = FMath::Max(InNumVertsX, 2);
+    Topology.NumVertsY = FMath::Max(InNumVertsY, 2);
+    Topology.NumPatches = FMath::Max(InNumPatches, 1);
+    Topology.Step = InStep;
+
+    const int32 NumVertsX = Topology.NumVertsX;
+    const int32 NumVertsY = Topology.NumVertsY;
+    const int32 NumVertices = Topology.GetNumVertices();
+    const int32 VertsPerPatch = NumVertsX * NumVertsY;
+
+    // 静态流：UV (每块网格内 0~1)
+    Topology.UVs.SetNumUninitialized(NumVertices);
+    for (int32 Index = 0; Index < NumVertices; Index++)
+    {
+        const int32 m = (Index % VertsPerPatch) / NumVertsX;
+        const int32 n = Index % NumVertsX;
+        Topology.UVs[Index] = FVector2f(n / (float)(NumVertsX - 1), m / (float)(NumVertsY - 1));
+    }
+
+    // 初始的平面网格 (多块时重叠在一起，等第一次更新)
+    const FOceanMeshTangent FlatTangent = MakeTangent(FVector3f(0.0f, 0.0f, 1.0f));
+    FOceanMeshStreams& Streams = Topology.FlatStreams;
+    Streams.SetNumUninitialized(NumVertices);
+    for (int32 Index = 0; Index < NumVertices; Index++)
+    {
+        const FVector2f& UV = Topology.UVs[Index];
+        Streams.Positions[Index] = FVector3f(UV.X * (NumVertsX - 1) * InStep, UV.Y * (NumVertsY - 1) * InStep, 0.0f);
+        Streams.Tangents[Index] = FlatTangent;
+    }
+
+    if (bWithIndices)
+    {
+        OceanMesh::BuildGridIndices(NumVertsX, NumVertsY, Topology.NumPatches, Topology.Indices);
+    }
+    return Topology;
+}
+
+
+void UOceanMeshComponent::SwapStreams(FOceanMeshStreams& InOutStreams)
+{
+    const int32 NumVertices = GetNumVertices();
+    if (NumVertices == 0 || InOutStreams.Num() != NumVertices) return;
+
+    // 1. 这份暂存缓冲两帧之前交给过渲染线程，确认已经用完 (通常早就完成，不会阻塞)
+    const int32 Slot = PendingIndex;
+    PendingFences[Slot].Wait();
+
+    // 2. 交换数组 (只交换指针，不拷贝)
+    Swap(PendingStreams[Slot], InOutStreams);
+    InOutStreams.SetNumUninitialized(NumVertices);
+
+    // 3. 渲染线程把它 memcpy 到 GPU
+    if (FOceanMeshSceneProxy* OceanProxy = static_cast<FOceanMeshSceneProxy*>(SceneProxy))
+    {
+        const FOceanMeshStreams* Streams = &PendingStreams[Slot];
+        ENQUEUE_RENDER_COMMAND(UpdateOceanMeshStreams)([OceanProxy, Streams](FRHICommandListImmediate& RHICmdList)
+        {
+            OceanProxy->UpdateStreams_RenderThread(RHICmdList, *Streams);
+        });
+        PendingFences[Slot].BeginFence();
+    }
+
+    LastSubmittedIndex = Slot;
+    PendingIndex = 1 - PendingIndex;
+}
+
+
+void UOceanMeshComponent::SetLocalBounds(const FBox& InLocalBounds)
+{
+    LocalBoundsOverride = InLocalBounds;
+    UpdateBounds();
+    MarkRenderTransformDirty();
+}
+
+
+void UOceanMeshComponent::FlushPendingStreams()
+{
+    for (FRenderCommandFence& Fence : PendingFences)
+    {
+        Fence.Wait();
+    }
+}
+
+
+FPrimitiveSceneProxy* UOceanMeshComponent::CreateSceneProxy()
+{
+    if (GetNumVertices() == 0) return nullptr;
+
+    const FOceanMeshStreams* InitialStreams = (LastSubmittedIndex != INDEX_NONE) ? &PendingStreams[LastSubmittedIndex] : &PendingStreams[0];
+    FOceanMeshSceneProxy* Proxy = new FOceanMeshSceneProxy(this, InitialStreams, UVs, OceanMesh::AcquireGridIndexBuffer(NumVertsX, NumVertsY, NumPatches, MoveTemp(PreparedIndices)));
+    PreparedIndices.Empty();
+    return Proxy;
+}
+
+
+FBoxSphereBounds UOceanMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+    // 平面网格 (或指定的范围) + 位移余量 (顶点每帧都在动，但包围盒固定，不需要每帧重算)
+    FBox LocalBox = LocalBoundsOverride.IsValid
+        ? LocalBoundsOverride
+        : FBox(FVector(0.0f, 0.0f, 0.0f), FVector((NumVertsX - 1) * GridStep, (NumVertsY - 1) * GridStep, 0.0f));
+    LocalBox = LocalBox.ExpandBy(BoundsPadding);
+    return FBoxSphereBounds(LocalBox).TransformBy(LocalToWorld);
+}
+
+
+void UOceanMeshComponent::BeginDestroy()
+{
+    Super::BeginDestroy();
+
+    // 渲染线程的更新命令引用了暂存缓冲，销毁前要等它们执行完
+    for (FRenderCommandFence& Fence : PendingFences)
+    {
+        Fence.BeginFence();
+    }
+}
+
+
+bool UOceanMeshComponent::IsReadyForFinishDestroy()
+{
+    return Super::IsReadyForFinishDestroy() && PendingFences[0].IsFenceComplete() && PendingFences[1].IsFenceComplete();
+}
@@ -0,0 +1,170 @@
+#include "OceanQuadtree.h"
+
+namespace OceanQuadtree
+{
+    // 第 Level 层的可见距离：LOD0Range * 2^Level
+    static float GetLevelRange(const FOceanQuadtreeSettings& Settings, int32 Level)
+    {
+        return Settings.LOD0Range * (float)(1 << Level);
+    }
+
+    // 相机到节点 (z = 0 平面上的正方形) 最近一点的距离的平方
+    static float GetDistanceSquared(const FVector2f& Origin, float Size, const FVector3f& ViewPosition)
+    {
+        const float dx = FMath::Max3(Origin.X - ViewPosition.X, 0.0f, ViewPosition.X - (Origin.X + Size));
+        const float dy = FMath::Max3(Origin.Y - ViewPosition.Y, 0.0f, ViewPosition.Y - (Origin.Y + Size));
+        return dx * dx + dy * dy + ViewPosition.Z * ViewPosition.Z;
+    }
+
+    // 节点与以相机为中心、半径 Range 的球是否相交
+    static bool IntersectsSphere(const FVector2f& Origin, float Size, const FVector3f& ViewPosition, float Range)
+    {
+        return GetDistanceSquared(Origin, Size, ViewPosition) <= Range * Range;
+    }
+
+    // 先全部收集，超出 MaxPatches 的部分在 SelectPatches 最后按距离去掉
+    static void AddPatch(const FOceanQuadtreeSettings& Settings, const FVector2f& Origin, float Size, int32 Level, int32 CellStride, TArray<FOceanQuadtreePatch>& OutPatches)
+    {
+        FOceanQuadtreePatch& Patch = OutPatches.AddDefaulted_GetRef();
+        Patch.Origin = Origin;
+        Patch.Size = Size;
+        Patch.Level = Level;
+        Patch.CellStride = CellStride;
+    }
+
+    // 标准的 CDLOD 选择：返回 false 表示这个节点不在本层范围内，由父节点用更粗的一层覆盖
+    static bool SelectNode(const FOceanQuadtreeSettings& Settings, const FVector2f& Origin, float Size, int32 Level, const FVector3f& ViewPosition, TArray<FOceanQuadtreePatch>& OutPatches)
+    {
+        if (!IntersectsSphere(Origin, Size, ViewPosition, GetLevelRange(Settings, Level)))
+        {
+            return false;
+        }
+
+        // 最密的一层，或者下一层的范围碰不到这个节点：整块用本层绘制
+        if (Level == 0 || !IntersectsSphere(Origin, Size, ViewPosition, GetLevelRange(Settings, Level - 1)))
+        {
+            AddPatch(Settings, Origin, Size, Level, 1, OutPatches);
+            return true;
+        }
+
+        // 否则分成 4 个子节点，子节点不在下一层范围内的部分仍由本层绘制：
+        // 只画本节点的四分之一，格子大小必须和本层一致 (否则和相邻的本层网格块对不上)，
+        // 所以每个格子占 2 个顶点间隔 (多出来的顶点重合在一起)
+        const float HalfSize = Size * 0.5f;
+        for (int32 Child = 0; Child < 4; Child++)
+        {
+            const FVector2f ChildOrigin = Origin + FVector2f((Child & 1) * HalfSize, (Child >> 1) * HalfSize);
+            if (!SelectNode(Settings, ChildOrigin, HalfSize, Level - 1, ViewPosition, OutPatches))
+            {
+                AddPatch(Settings, ChildOrigin, HalfSize, Level, 2, OutPatches);
+            }
+        }
+        return true;
+    }
+
+    FOceanQuadtreeSettings Sanitize(const FOceanQuadtreeSettings& Settings)
+    {
+        FOceanQuadtreeSettings Result = Settings;
+        Result.NumLevels = FMath::Clamp(Result.NumLevels, 1, 16);
+        // 4 的倍数：CellStride 为 2 的四分之一块从节点原点偏移 Res/2 个父格子，Res/2 也必须是偶数，
+        // 块内格点的奇偶才和上一层的格点一致 (否则 Geomorphing 会移错格点，和相邻的块裂开)
+        Result.PatchResolution = FMath::Clamp(Result.PatchResolution, 4, 252) & ~3;
+        Result.MaxPatches = FMath::Max(Result.MaxPatches, 1);
+        Result.SeaSize = FMath::Max(Result.SeaSize, 1.0f);
+        Result.MorphStartRatio = FMath::Clamp(Result.MorphStartRatio, 0.0f, 0.95f);
+
+        // 相邻两层的交界处，细的一层必须已经完全过渡到粗的一层 (否则会有裂缝)
+        // 所以每层的过渡区域至少要比一块网格的对角线大
+        const float MinRange = Result.GetPatchSize(0) * UE_SQRT_2 * 2.0f;
+        Result.LOD0Range = FMath::Max(Result.LOD0Range, MinRange);
+        return Result;
+    }
+
+    void SelectPatches(const FOceanQuadtreeSettings& Settings, const FVector3f& ViewPosition, TArray<FOceanQuadtreePatch>& OutPatches)
+    {
+        OutPatches.Reset();
+
+        const float HalfSea = Settings.SeaSize * 0.5f;
+        const int32 RootLevel = Settings.NumLevels - 1;
+        const FVector2f RootOrigin(-HalfSea, -HalfSea);
+
+        // 根节点超出最远一层的范围时也要画出来 (远处整块用最粗的一层)
+        if (!SelectNode(Settings, RootOrigin, Settings.SeaSize, RootLevel, ViewPosition, OutPatches))
+        {
+            AddPatch(Settings, RootOrigin, Settings.SeaSize, RootLevel, 1, OutPatches);
+        }
+
+        // 块数超出顶点缓冲：保留离相机最近的 MaxPatches 块 (深度优先的遍历顺序和距离无关，不能直接截断)
+        if (OutPatches.Num() > Settings.MaxPatches)
+        {
+            OutPatches.Sort([&ViewPosition](const FOceanQuadtreePatch& A, const FOceanQuadtreePatch& B)
+            {
+                return GetDistanceSquared(A.Origin, A.Size, ViewPosition) < GetDistanceSquared(B.Origin, B.Size, ViewPosition);
+            });
+            OutPatches.SetNum(Settings.MaxPatches, EAllowShrinking::No);
+        }
+    }
+
+    void BuildVertices(const FOceanQuadtreeSettings& Settings, const TArray<FOceanQuadtreePatch>& Patches, const FVector3f& ViewPosition, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutStreams)
+    {
+        const int32 Res = Settings.PatchResolution;
+        const int32 RowVerts = Res + 1;
+        const int32 VertsPerPatch = Settings.GetVertsPerPatch();
+        if (OutStreams.Num() < Settings.MaxPatches * VertsPerPatch || !Sampler.IsValid()) return;
+
+        const FOceanMeshTangent FlatTangent = UOceanMeshComponent::MakeTangent(FVector3f(0.0f, 0.0f, 1.0f));
+
+        for (int32 PatchIndex = 0; PatchIndex < Settings.MaxPatches; PatchIndex++)
+        {
+            FVector3f* Positions = OutStreams.Positions.GetData() + PatchIndex * VertsPerPatch;
+            FOceanMeshTangent* Tangents = OutStreams.Tangents.GetData() + PatchIndex * VertsPerPatch;
+
+            // 没用到的网格块：缩成一个点
+            if (!Patches.IsValidIndex(PatchIndex))
+            {
+                for (int32 i = 0; i < VertsPerPatch; i++)
+                {
+                    Positions[i] = FVector3f::ZeroVector;
+                    Tangents[i] = FlatTangent;
+                }
+                continue;
+            }
+
+            const FOceanQuadtreePatch& Patch = Patches[PatchIndex];
+            const int32 Stride = Patch.CellStride;
+            const float CellSize = Patch.Size * Stride / Res;
+
+            // 本层的过渡区间：[MorphStart, MorphEnd]，到 MorphEnd 时完全变成上一层 (格子大一倍) 的形状
+            const float MorphEnd = GetLevelRange(Settings, Patch.Level);
+            const float PrevRange = (Patch.Level > 0) ? GetLevelRange(Settings, Patch.Level - 1) : 0.0f;
+            const float MorphStart = PrevRange + (MorphEnd - PrevRange) * Settings.MorphStartRatio;
+            const float InvMorphLength = 1.0f / FMath::Max(MorphEnd - MorphStart, 1.0f);
+
+            for (int32 m = 0; m < RowVerts; m++)
+            {
+                for (int32 n = 0; n < RowVerts; n++)
+                {
+                    // 1. 平面上的位置 (格点下标按 CellStride 合并)
+                    const int32 GridX = n / Stride;
+                    const int32 GridY = m / Stride;
+                    float X = Patch.Origin.X + GridX * CellSize;
+                    float Y = Patch.Origin.Y + GridY * CellSize;
+
+                    // 2. Geomorphing：奇数格点按距离滑向相邻的偶数格点 (上一层的格点)
+                    const float Distance = FVector3f::Dist(FVector3f(X, Y, 0.0f), ViewPosition);
+                    const float Morph = FMath::Clamp((Distance - MorphStart) * InvMorphLength, 0.0f, 1.0f);
+                    X -= (GridX & 1) * CellSize * Morph;
+                    Y -= (GridY & 1) * CellSize * Morph;
+
+                    // 3. 对周期性的海面采样
+                    FVector3f Offset, Normal;
+                    Sampler.Sample(X, Y, Offset, Normal);
+
+                    const int32 Index = m * RowVerts + n;
+                    Positions[Index] = FVector3f(X, Y, 0.0f) + Offset;
+                    Tangents[Index] = UOceanMeshComponent::MakeTangent(Normal);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include "OceanResolutionController.h"
+
+
+void FOceanResolutionController::Reset()
+{
+    AccumulatedMs = 0.0;
+    NumFrames = 0;
+}
+
+
+int32 FOceanResolutionController::Update(const FOceanAdaptiveResolutionSettings& Settings, int32 CurrentResolution, float CostMs)
+{
+    // 1. 攒够一个窗口再判断 (单帧的开销受调度影响很大)
+    AccumulatedMs += CostMs;
+    NumFrames++;
+    if (NumFrames < FMath::Max(Settings.EvaluationFrames, 1))
+    {
+        return CurrentResolution;
+    }
+
+    AverageCostMs = (float)(AccumulatedMs / NumFrames);
+    Reset();
+
+    // 2. 超出目标：降一档
+    if (AverageCostMs > Settings.TargetMs)
+    {
+        return GetLowerResolution(Settings, CurrentResolution);
+    }
+
+    // 3. 开销大致和顶点数 (分辨率的平方) 成正比，预计升档之后仍然留有余量才升
+    const int32 Higher = GetHigherResolution(Settings, CurrentResolution);
+    const float Ratio = FMath::Square((float)Higher / CurrentResolution);
+    if (Higher != CurrentResolution && AverageCostMs * Ratio < Settings.TargetMs * (1.0f - Settings.Hysteresis))
+    {
+        return Higher;
+    }
+
+    return CurrentResolution;
+}
+
+
+int32 FOceanResolutionController::GetLowerResolution(const FOceanAdaptiveResolutionSettings& Settings, int32 Resolution)
+{
+    const int32 MinResolution = FMath::Max(Settings.MinResolution, 4);
+    return FMath::Min(Resolution, FMath::Max(Resolution / 2, MinResolution));
+}
+
+
+int32 FOceanResolutionController::GetHigherResolution(const FOceanAdaptiveResolutionSettings& Settings, int32 Resolution)
+{
+    const int32 MinResolution = FMath::Max(Settings.MinResolution, 4);
+    const int32 MaxResolution = FMath::Max(Settings.MaxResolution, MinResolution);
+    return FMath::Max(Resolution, FMath::Min(Resolution * 2, MaxResolution));
+}
@@ -0,0 +1,636 @@
+#include "OceanSimulation.h"
+#include "OceanStats.h"
+#include "HAL/PlatformTime.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Time Slice"), STAT_OceanTimeSlice, STATGROUP_Ocean);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Time Slice Chunks Done"), STAT_OceanTimeSliceChunksDone, STATGROUP_Ocean);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Time Slice Chunks Deferred"), STAT_OceanTimeSliceChunksDeferred, STATGROUP_Ocean);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Time Slice Keyframe Interval (ms)"), STAT_OceanTimeSliceInterval, STATGROUP_Ocean);
+
+
+FOceanSpectrumSimulation::FOceanSpectrumSimulation(const FOceanSpectrumSettings& InSettings)
+    : Settings(InSettings)
+{
+    // 构建 FFT 计划 (旋转因子 + 位反转表只在创建时算)
+    Settings.N = FMath::Max(Settings.N, 4);
+    FFTPlan.Initialize(Settings.N);
+
+    // 结果缓冲在第一次用到时分配 (见 Simulate)，之后每帧不再分配
+    BuildSpectrum();
+}
+
+
+FOceanSpectrumSimulation::~FOceanSpectrumSimulation()
+{
+    // 任务持有 this 和缓冲的指针，销毁之前必须等它们结束
+    Wait();
+}
+
+
+UE::Tasks::FTask FOceanSpectrumSimulation::Simulate(float Time, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice)
+{
+    // 1. 这一帧已经有人请求过同一时间：直接共用同一份结果
+    for (int32 Index = 0; Index < NumBuffers; Index++)
+    {
+        if (Buffers[Index].Frame == GFrameCounter && Buffers[Index].Time == Time)
+        {
+            CurrentBuffer = Index;
+            return Buffers[Index].Task;
+        }
+    }
+
+    // 2. 这一帧的第一次请求决定分时设置，关键帧的推进和预算只算在这一次上
+    const bool bFirstInFrame = (SimulatedFrame != GFrameCounter);
+    if (bFirstInFrame)
+    {
+        SimulatedFrame = GFrameCounter;
+        FrameTimeSlice = TimeSlice;
+    }
+
+    // 3. 换一块缓冲：上次写它的任务和读它的任务都结束之后才能覆盖 (作为前置任务，不阻塞游戏线程)
+    CurrentBuffer = AcquireBuffer();
+    FBuffer& Buffer = Buffers[CurrentBuffer];
+    Buffer.Frame = GFrameCounter;
+    Buffer.Time = Time;
+    if (Buffer.Workspace.SlopeYField.Num() != Settings.N * Settings.N)
+    {
+        Buffer.Workspace.Resize(Settings.N);
+    }
+
+    TArray<UE::Tasks::FTask> Prerequisites = MoveTemp(Buffer.Readers);
+    Buffer.Readers.Reset();
+    if (Buffer.Task.IsValid())
+    {
+        Prerequisites.Add(Buffer.Task);
+    }
+
+    FOceanFFTWorkspace* Workspace = &Buffer.Workspace;
+    if (!FrameTimeSlice.bEnabled)
+    {
+        bWasTimeSliced = false;
+        Buffer.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Time, Parallel, Workspace]()
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            Run(Time, Parallel, *Workspace);
+            LastRunMs.store((float)((FPlatformTime::Seconds() - StartTime) * 1000.0), std::memory_order_relaxed);
+        }, Prerequisites);
+        return Buffer.Task;
+    }
+
+    // 分时模式：关键帧的状态在前后两个分时任务之间传递，所以还要排在上一个分时任务之后
+    if (LastTimeSlicedTask.IsValid())
+    {
+        Prerequisites.Add(LastTimeSlicedTask);
+    }
+
+    const bool bRestart = !bWasTimeSliced;
+    bWasTimeSliced = true;
+    const FOceanTimeSliceSettings SliceSettings = FrameTimeSlice;
+    Buffer.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Time, Parallel, SliceSettings, bRestart, bFirstInFrame, Workspace]()
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        RunTimeSliced(Time, Parallel, SliceSettings, bRestart, bFirstInFrame, *Workspace);
+
+        // 只插值的那一次不算开销，否则自适应分辨率会低估这一帧
+        if (bFirstInFrame)
+        {
+            LastRunMs.store((float)((FPlatformTime::Seconds() - StartTime) * 1000.0), std::memory_order_relaxed);
+        }
+    }, Prerequisites);
+    LastTimeSlicedTask = Buffer.Task;
+
+    return Buffer.Task;
+}
+
+
+int32 FOceanSpectrumSimulation::AcquireBuffer() const
+{
+    int32 Unused = INDEX_NONE;
+    int32 Oldest = INDEX_NONE;
+    for (int32 Index = 0; Index < NumBuffers; Index++)
+    {
+        const uint64 Frame = Buffers[Index].Frame;
+        if (Frame == MAX_uint64)
+        {
+            Unused = (Unused == INDEX_NONE) ? Index : Unused;
+            continue;
+        }
+
+        // 两帧以前的：已经分配好，读者一般也早就结束了
+        if (Frame + 1 < GFrameCounter)
+        {
+            return Index;
+        }
+        if (Frame != GFrameCounter && (Oldest == INDEX_NONE || Frame < Buffers[Oldest].Frame))
+        {
+            Oldest = Index;
+        }
+    }
+
+    if (Unused != INDEX_NONE) return Unused;
+    if (Oldest != INDEX_NONE) return Oldest;
+
+    // 同一帧里的时间比缓冲还多：覆盖下一块 (前置任务保证不会写到还在读的数据)
+    return (CurrentBuffer + 1) % NumBuffers;
+}
+
+
+FOceanSurfaceSampler FOceanSpectrumSimulation::GetSampler() const
+{
+    // 解包：实部 / 虚部分别就是两个通道
+    const FOceanFFTWorkspace& Workspace = Buffers[CurrentBuffer].Workspace;
+
+    FOceanSurfaceSampler Sampler;
+    Sampler.Height = Workspace.PackedHeightDispX.Re.GetData();
+    Sampler.DispX = Workspace.PackedHeightDispX.Im.GetData();
+    Sampler.DispY = Workspace.PackedDispYSlopeX.Re.GetData();
+    Sampler.SlopeX = Workspace.PackedDispYSlopeX.Im.GetData();
+    Sampler.SlopeY = Workspace.SlopeYField.GetData();
+    Sampler.N = Settings.N;
+    Sampler.TileSize = Settings.OceanSize;
+    Sampler.HeightScale = HeightScale;
+    return Sampler;
+}
+
+
+void FOceanSpectrumSimulation::AddReader(const UE::Tasks::FTask& Task)
+{
+    Buffers[CurrentBuffer].Readers.Add(Task);
+}
+
+
+void FOceanSpectrumSimulation::Wait()
+{
+    LastTimeSlicedTask = UE::Tasks::FTask();
+    for (FBuffer& Buffer : Buffers)
+    {
+        UE::Tasks::Wait(Buffer.Readers);
+        Buffer.Readers.Reset();
+
+        if (Buffer.Task.IsValid())
+        {
+            Buffer.Task.Wait();
+            Buffer.Task = UE::Tasks::FTask();
+        }
+    }
+}
+
+
+// 计算初始频谱和每个频点的预计算表 (只算 kx >= 0 的一半：N 行 x (N/2+1) 列)
+// 按 FFT 的存储顺序排列：下标 0..(N-1)/2 是正频率，其余是负频率
+// 时间演化只需要 h0(k) 与 h0(-k) 的和与差，所以直接存这两项，每帧不再按镜像下标跳着读
+void FOceanSpectrumSimulation::BuildSpectrum()
+{
+    const int32 N = Settings.N;
+    const int32 HalfSize = N / 2 + 1;
+    const int32 Count = N * HalfSize;
+
+    KMagTable.SetNumUninitialized(Count, EAllowShrinking::No);
+    OmegaTable.SetNumUninitialized(Count, EAllowShrinking::No);
+    H0Sum.SetNumUninitialized(Count);
+    H0Diff.SetNumUninitialized(Count);
+
+    for (int32 m = 0; m < N; m++)
+    {
+        // -k 所在的行 (镜像)
+        int32 MirrorRow = (N - m) % N;
+
+        for (int32 n = 0; n < HalfSize; n++)
+        {
+            int32 Index = m * HalfSize + n;
+
+            // 1. 波数下标映射到 [-N/2, N/2] 区间
+            int32 kxIndex = OceanFFT::SignedFrequency(n, N);
+            int32 kyIndex = OceanFFT::SignedFrequency(m, N);
+            float kx = (2.0f * PI * kxIndex) / Settings.OceanSize;
+            float ky = (2.0f * PI * kyIndex) / Settings.OceanSize;
+            float kMag = FMath::Sqrt(kx * kx + ky * ky);
+
+            // 2. 色散关系 w = sqrt(g * |k|)
+            // 直流分量：|k| = 0 时 Phillips 为 0，h0 和 w 都是 0，演化结果自然为 0，不需要分支
+            KMagTable[Index] = kMag;
+            OmegaTable[Index] = FMath::Sqrt(9.81f * kMag);
+
+            // 3. h0(k) 和 h0(-k)
+            float H0Re, H0Im, MirrorRe, MirrorIm;
+            CalculateH0(kxIndex, kyIndex, H0Re, H0Im);
+            CalculateH0(OceanFFT::SignedFrequency((N - n) % N, N), OceanFFT::SignedFrequency(MirrorRow, N), MirrorRe, MirrorIm);
+
+            // 4. Nyquist 裁剪：k 和 -k 的波长相同，权重也相同
+            const float Fade = (kMag > 0.0f) ? OceanFFT::GetWavelengthFade(2.0f * PI / kMag, Settings.CutoffWavelength, Settings.CutoffFadeWidth) : 1.0f;
+
+            H0Sum.Re[Index] = (H0Re + MirrorRe) * Fade;
+            H0Sum.Im[Index] = (H0Im + MirrorIm) * Fade;
+            H0Diff.Re[Index] = (H0Re - MirrorRe) * Fade;
+            H0Diff.Im[Index] = (H0Im - MirrorIm) * Fade;
+        }
+    }
+
+    // 5. |kx| 或 |ky| 的下标超过 OceanSize / CutoffWavelength 的频点波长一定 <= 截止波长，整行 (列) 都是 0
+    CutoffIndex = N / 2;
+    if (Settings.CutoffWavelength > 0.0f)
+    {
+        CutoffIndex = FMath::Clamp(FMath::FloorToInt(Settings.OceanSize / Settings.CutoffWavelength), 0, N / 2);
+    }
+}
+
+
+// 单个频点的初始振幅 h0(k) = 高斯噪声 * sqrt(P(k) / 2)
+void FOceanSpectrumSimulation::CalculateH0(int32 kxIndex, int32 kyIndex, float& OutRe, float& OutIm) const
+{
+    const int32 N = Settings.N;
+    float kx = (2.0f * PI * kxIndex) / Settings.OceanSize;
+    float ky = (2.0f * PI * kyIndex) / Settings.OceanSize;
+    FVector2D k(kx, ky);
+
+    // 获取 Phillips 能量值
+    float P = CalculatePhillips(k);
+
+    // 使用哈希代替随机数 (解决抖动问题的核心)
+    // 哈希仍按"居中"排列的下标计算，保证每个 k 的随机数和以前一样
+    int32 HashIndex = (kyIndex + N / 2) * N + (kxIndex + N / 2);
+    float r1 = FMath::Frac(FMath::Sin(HashIndex * 12.9898f) * 43758.5453f);
+    float r2 = FMath::Frac(FMath::Sin(HashIndex * 78.233f) * 43758.5453f);
+
+    float noise = FMath::Sqrt(-2.0f * FMath::Loge(FMath::Max(r1, 0.0001f)));
+    OutRe = noise * FMath::Cos(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
+    OutIm = noise * FMath::Sin(2.0f * PI * r2) * FMath::Sqrt(P * 0.5f);
+}
+
+
+// 时间演化：h(k, t) = h0(k) * e^(i*w*t) + conj(h0(-k)) * e^(-i*w*t)
+// 展开后 = [Sum.Re * cos - Sum.Im * sin] + i * [Diff.Re * sin + Diff.Im * cos]
+// 所有表都是连续、对齐的一维数组，每次处理 4 个频点 (一次 sincos + 几个乘加)
+void FOceanSpectrumSimulation::EvolveSpectrum(float Time, FOceanComplexArray& OutSpectrum, int32 Begin, int32 End) const
+{
+    // Begin 必须是 4 的倍数 (对齐读写)，End 可以是任意值
+    check(Begin % 4 == 0 && End <= OmegaTable.Num());
+    const int32 Count = End;
+    OutSpectrum.SetNumUninitialized(OmegaTable.Num());
+
+    const float* Omega = OmegaTable.GetData();
+    const float* SumRe = H0Sum.Re.GetData();
+    const float* SumIm = H0Sum.Im.GetData();
+    const float* DiffRe = H0Diff.Re.GetData();
+    const float* DiffIm = H0Diff.Im.GetData();
+    float* OutRe = OutSpectrum.Re.GetData();
+    float* OutIm = OutSpectrum.Im.GetData();
+
+    int32 Index = Begin;
+    const VectorRegister4Float VTime = VectorSetFloat1(Time);
+    for (; Index + 4 <= Count; Index += 4)
+    {
+        const VectorRegister4Float Phase = VectorMultiply(VectorLoadAligned(Omega + Index), VTime);
+        VectorRegister4Float SinPhase, CosPhase;
+        VectorSinCos(&SinPhase, &CosPhase, &Phase);
+
+        const VectorRegister4Float Re = VectorNegateMultiplyAdd(VectorLoadAligned(SumIm + Index), SinPhase,
+            VectorMultiply(VectorLoadAligned(SumRe + Index), CosPhase));
+        const VectorRegister4Float Im = VectorMultiplyAdd(VectorLoadAligned(DiffRe + Index), SinPhase,
+            VectorMultiply(VectorLoadAligned(DiffIm + Index), CosPhase));
+
+        VectorStoreAligned(Re, OutRe + Index);
+        VectorStoreAligned(Im, OutIm + Index);
+    }
+
+    // 剩下不足 4 个的尾部
+    for (; Index < Count; Index++)
+    {
+        float SinPhase, CosPhase;
+        FMath::SinCos(&SinPhase, &CosPhase, Omega[Index] * Time);
+        OutRe[Index] = SumRe[Index] * CosPhase - SumIm[Index] * SinPhase;
+        OutIm[Index] = DiffRe[Index] * SinPhase + DiffIm[Index] * CosPhase;
+    }
+}
+
+
+
+// 一帧完整的模拟：时间演化 + IFFT
+// 只读取频谱表和 FFT 计划，只写传入的 Workspace，可以在后台线程运行 (两块缓冲的任务也可以同时运行)
+void FOceanSpectrumSimulation::Run(float Time, const FOceanFFTParallelSettings& Parallel, FOceanFFTWorkspace& Workspace) const
+{
+    // 缓冲都在 Workspace 里，构造时已按 N 分配好 (这里的 Resize 不会再分配)
+    Workspace.Resize(Settings.N);
+
+    for (int32 Stage = 0; Stage < (int32)EStage::Count; Stage++)
+    {
+        RunStage((EStage)Stage, Time, 0, GetStageSize((EStage)Stage), Parallel, Workspace);
+    }
+}
+
+
+int32 FOceanSpectrumSimulation::GetStageSize(EStage Stage) const
+{
+    // 列数：C2R 的频谱只有 N/2+1 列，其余都是 N 行 (列)
+    return (Stage == EStage::SlopeYColumns) ? Settings.N / 2 + 1 : Settings.N;
+}
+
+
+void FOceanSpectrumSimulation::RunStage(EStage Stage, float Time, int32 Begin, int32 End, const FOceanFFTParallelSettings& Parallel, FOceanFFTWorkspace& Workspace) const
+{
+    const int32 N = Settings.N;
+    const int32 HalfSize = N / 2 + 1;
+    FOceanComplexArray& PackedHeightDispX = Workspace.PackedHeightDispX;
+    FOceanComplexArray& PackedDispYSlopeX = Workspace.PackedDispYSlopeX;
+    FOceanComplexArray& SlopeYSpectrum = Workspace.SlopeYSpectrum;
+    const FOceanFFTPlan& ComplexPlan = FFTPlan.GetComplexPlan();
+
+    switch (Stage)
+    {
+    case EStage::Evolve:
+    {
+        // ==========================================
+        // 1. 时间演化
+        // ==========================================
+        // 高度场是实数，频谱共轭对称，所以只演化 kx >= 0 的一半：N 行 x (N/2+1) 列
+        // h(k, t) = h0(k) * e^(i*w*t) + conj(h0(-k)) * e^(-i*w*t)
+        // 行号换成元素下标，起点向下对齐到 4 (相邻两段仍然首尾相接)
+        auto RowToElement = [&](int32 Row) { return (Row >= N) ? N * HalfSize : (Row * HalfSize) & ~3; };
+
+        // Nyquist 裁剪掉的行 (|ky| > CutoffIndex，连续的一段) 直接清零，不求 sin / cos
+        // 这一段的两端向内对齐到 4：边上多演化几个 0 频点不影响结果
+        const int32 ZeroBegin = Align((CutoffIndex + 1) * HalfSize, 4);
+        const int32 ZeroEnd = ((N - CutoffIndex) * HalfSize) & ~3;
+        const int32 ElementBegin = RowToElement(Begin);
+        const int32 ElementEnd = RowToElement(End);
+        ForEachNonZeroRange(ElementBegin, ElementEnd, ZeroBegin, ZeroEnd, [&](int32 RangeBegin, int32 RangeEnd)
+        {
+            EvolveSpectrum(Time, Workspace.Spectrum, RangeBegin, RangeEnd);
+        });
+
+        const int32 ClearBegin = FMath::Max(ElementBegin, ZeroBegin);
+        const int32 ClearEnd = FMath::Min(ElementEnd, ZeroEnd);
+        if (ClearBegin < ClearEnd)
+        {
+            FMemory::Memzero(Workspace.Spectrum.Re.GetData() + ClearBegin, (ClearEnd - ClearBegin) * sizeof(float));
+            FMemory::Memzero(Workspace.Spectrum.Im.GetData() + ClearBegin, (ClearEnd - ClearBegin) * sizeof(float));
+        }
+        break;
+    }
+
+    case EStage::Pack:
+        // ==========================================
+        // 2. 多通道频谱：高度、水平位移、斜率
+        // ==========================================
+        // 五个实数通道 (都由 h(k,t) 乘以一个因子得到)：
+        //   高度     h
+        //   位移 X   i*kx/|k|*h      位移 Y   i*ky/|k|*h
+        //   斜率 X   i*kx*h          斜率 Y   i*ky*h
+        // 两个实数信号可以打包进一次复数 FFT (A + i*B)，输出的实部是 A、虚部是 B：
+        //   FFT 1 = 高度 + i*位移X，FFT 2 = 位移Y + i*斜率X，FFT 3 = 斜率Y (单独走 C2R)
+        // 所以三次 FFT 就能得到精确的位移和法线，不再需要空间差分
+        PackChannels(Workspace, Begin, End);
+        break;
+
+    // 执行 IFFT (行 (列) 之间互不依赖，分给多个工作线程)
+    // 复数变换先行后列，C2R 先列后行
+    // 第一步变换时 Nyquist 裁剪掉的行 (列) 全是 0，变换之后还是 0，直接跳过
+    case EStage::ComplexRows:
+        ForEachNonZeroRange(Begin, End, CutoffIndex + 1, N - CutoffIndex, [&](int32 RangeBegin, int32 RangeEnd)
+        {
+            ComplexPlan.Inverse2DRows(PackedHeightDispX.Re.GetData(), PackedHeightDispX.Im.GetData(), RangeBegin, RangeEnd, Workspace.FFTScratch, Parallel);
+            ComplexPlan.Inverse2DRows(PackedDispYSlopeX.Re.GetData(), PackedDispYSlopeX.Im.GetData(), RangeBegin, RangeEnd, Workspace.FFTScratch, Parallel);
+        });
+        break;
+
+    case EStage::ComplexColumns:
+        ComplexPlan.Inverse2DColumns(PackedHeightDispX.Re.GetData(), PackedHeightDispX.Im.GetData(), Begin, End, Workspace.FFTScratch, Parallel);
+        ComplexPlan.Inverse2DColumns(PackedDispYSlopeX.Re.GetData(), PackedDispYSlopeX.Im.GetData(), Begin, End, Workspace.FFTScratch, Parallel);
+        break;
+
+    case EStage::SlopeYColumns:
+        ForEachNonZeroRange(Begin, End, CutoffIndex + 1, HalfSize, [&](int32 RangeBegin, int32 RangeEnd)
+        {
+            FFTPlan.Inverse2DColumns(SlopeYSpectrum.Re.GetData(), SlopeYSpectrum.Im.GetData(), RangeBegin, RangeEnd, Workspace.FFTScratch, Parallel);
+        });
+        break;
+
+    case EStage::SlopeYRows:
+        FFTPlan.Inverse2DRows(SlopeYSpectrum.Re.GetData(), SlopeYSpectrum.Im.GetData(), Workspace.SlopeYField.GetData(), Begin, End, Workspace.FFTScratch, Parallel);
+        break;
+
+    default:
+        checkNoEntry();
+        break;
+    }
+}
+
+
+// ==========================================
+// 分时更新
+// ==========================================
+// 关键帧在请求时间 s 开始计算，目标时间是 s + I (I 为算完一个关键帧需要的时间)，所以算完的时候正好"赶上"
+// 显示时间取 t - I：总是落在最近两个算好的关键帧之间，插值得到平滑的运动，代价是晚 I 左右
+// I 随帧率和预算变化，显示用的延迟只能慢慢跟上，否则关键帧切换时海面会跳
+void FOceanSpectrumSimulation::RunTimeSliced(float Time, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice, bool bRestart, bool bAdvance, FOceanFFTWorkspace& Output)
+{
+    SCOPE_CYCLE_COUNTER(STAT_OceanTimeSlice);
+    const int32 RowsPerChunk = FMath::Max(TimeSlice.RowsPerChunk, 1);
+
+    if (bRestart || !bTimeSliceReady)
+    {
+        // 1. 刚打开分时：两个关键帧直接完整算好 (只有这一帧会超出预算)
+        for (FKeyframe& Keyframe : Keyframes)
+        {
+            Keyframe.Workspace.Resize(Settings.N);
+        }
+
+        DisplayDelay = KeyframeInterval;
+        LastSliceTime = Time;
+        Keyframes[OlderKey].Time = Time - KeyframeInterval;
+        Keyframes[NewerKey].Time = Time;
+        Run(Keyframes[OlderKey].Time, Parallel, Keyframes[OlderKey].Workspace);
+        Run(Keyframes[NewerKey].Time, Parallel, Keyframes[NewerKey].Workspace);
+
+        StartKeyframe(Time + KeyframeInterval, Time);
+        bTimeSliceReady = true;
+    }
+    else if (bAdvance)
+    {
+        // 2. 在预算内一块一块地推进 (至少一块，保证总会算完)
+        // 每帧最多完成一个关键帧：新的关键帧从下一帧开始算，这样间隔至少是一帧
+        const double Deadline = FPlatformTime::Seconds() + TimeSlice.BudgetMs * 0.001;
+        int32 ChunksDone = 0;
+        do
+        {
+            ChunksDone++;
+            if (RunKeyframeChunk(Parallel, RowsPerChunk))
+            {
+                // 记下这次用了多久，轮换关键帧：最旧的那份缓冲拿来算下一个
+                KeyframeInterval = FMath::Max(Time - BuildingStartTime, 0.001f);
+
+                const int32 FreeKey = OlderKey;
+                OlderKey = NewerKey;
+                NewerKey = BuildingKey;
+                BuildingKey = FreeKey;
+                StartKeyframe(Time + KeyframeInterval, Time);
+                break;
+            }
+        } while (FPlatformTime::Seconds() < Deadline);
+
+        SET_DWORD_STAT(STAT_OceanTimeSliceChunksDone, ChunksDone);
+    }
+
+    // 3. 显示延迟每帧最多变化帧间隔的一半 (海面的速度在 0.5 到 1.5 倍之间)，再插值得到这一帧的海面
+    // 同一帧的第二个时间只插值：时间可能比第一个还早，不能拿来算帧间隔
+    if (bAdvance)
+    {
+        SET_DWORD_STAT(STAT_OceanTimeSliceChunksDeferred, GetRemainingChunks(RowsPerChunk));
+        const float MaxDelayChange = FMath::Max(Time - LastSliceTime, 0.0f) * 0.5f;
+        DisplayDelay += FMath::Clamp(KeyframeInterval - DisplayDelay, -MaxDelayChange, MaxDelayChange);
+        LastSliceTime = Time;
+
+        SET_FLOAT_STAT(STAT_OceanTimeSliceInterval, KeyframeInterval * 1000.0f);
+    }
+    BlendKeyframes(Time - DisplayDelay, Output);
+}
+
+
+void FOceanSpectrumSimulation::StartKeyframe(float Time, float RequestTime)
+{
+    Keyframes[BuildingKey].Time = Time;
+    BuildingStage = EStage::Evolve;
+    BuildingProgress = 0;
+    BuildingStartTime = RequestTime;
+}
+
+
+bool FOceanSpectrumSimulation::RunKeyframeChunk(const FOceanFFTParallelSettings& Parallel, int32 RowsPerChunk)
+{
+    FKeyframe& Keyframe = Keyframes[BuildingKey];
+    const int32 StageSize = GetStageSize(BuildingStage);
+    const int32 End = FMath::Min(BuildingProgress + RowsPerChunk, StageSize);
+    RunStage(BuildingStage, Keyframe.Time, BuildingProgress, End, Parallel, Keyframe.Workspace);
+
+    // 这一步做完了就进入下一步
+    BuildingProgress = End;
+    if (BuildingProgress >= StageSize)
+    {
+        BuildingStage = (EStage)((int32)BuildingStage + 1);
+        BuildingProgress = 0;
+    }
+    return BuildingStage == EStage::Count;
+}
+
+
+int32 FOceanSpectrumSimulation::GetRemainingChunks(int32 RowsPerChunk) const
+{
+    int32 Remaining = 0;
+    for (int32 Stage = (int32)BuildingStage; Stage < (int32)EStage::Count; Stage++)
+    {
+        const int32 Done = (Stage == (int32)BuildingStage) ? BuildingProgress : 0;
+        Remaining += FMath::DivideAndRoundUp(GetStageSize((EStage)Stage) - Done, RowsPerChunk);
+    }
+    return Remaining;
+}
+
+
+void FOceanSpectrumSimulation::BlendKeyframes(float Time, FOceanFFTWorkspace& Output) const
+{
+    const FKeyframe& Older = Keyframes[OlderKey];
+    const FKeyframe& Newer = Keyframes[NewerKey];
+    const float Span = Newer.Time - Older.Time;
+    const float Alpha = (Span > 0.0f) ? FMath::Clamp((Time - Older.Time) / Span, 0.0f, 1.0f) : 1.0f;
+
+    // 五个输出通道都是 N x N 的实数场，逐个元素 a + (b - a) * Alpha
+    const int32 Count = Settings.N * Settings.N;
+    auto Blend = [Count, Alpha](const FOceanAlignedFloatArray& A, const FOceanAlignedFloatArray& B, FOceanAlignedFloatArray& Out)
+    {
+        const float* APtr = A.GetData();
+        const float* BPtr = B.GetData();
+        float* OutPtr = Out.GetData();
+        for (int32 Index = 0; Index < Count; Index++)
+        {
+            OutPtr[Index] = APtr[Index] + (BPtr[Index] - APtr[Index]) * Alpha;
+        }
+    };
+
+    Blend(Older.Workspace.PackedHeightDispX.Re, Newer.Workspace.PackedHeightDispX.Re, Output.PackedHeightDispX.Re);
+    Blend(Older.Workspace.PackedHeightDispX.Im, Newer.Workspace.PackedHeightDispX.Im, Output.PackedHeightDispX.Im);
+    Blend(Older.Workspace.PackedDispYSlopeX.Re, Newer.Workspace.PackedDispYSlopeX.Re, Output.PackedDispYSlopeX.Re);
+    Blend(Older.Workspace.PackedDispYSlopeX.Im, Newer.Workspace.PackedDispYSlopeX.Im, Output.PackedDispYSlopeX.Im);
+    Blend(Older.Workspace.SlopeYField, Newer.Workspace.SlopeYField, Output.SlopeYField);
+}
+
+
+// 由演化后的一半频谱生成 [RowBegin, RowEnd) 行的打包通道 (需要整个 Spectrum 都已演化好：每行要读镜像行)
+void FOceanSpectrumSimulation::PackChannels(FOceanFFTWorkspace& Workspace, int32 RowBegin, int32 RowEnd) const
+{
+    const int32 N = Settings.N;
+    const int32 HalfSize = N / 2 + 1;
+    const FOceanComplexArray& h_tilde_t = Workspace.Spectrum;
+    FOceanComplexArray& PackedHeightDispX = Workspace.PackedHeightDispX;
+    FOceanComplexArray& PackedDispYSlopeX = Workspace.PackedDispYSlopeX;
+    FOceanComplexArray& SlopeYSpectrum = Workspace.SlopeYSpectrum;
+
+    for (int32 m = RowBegin; m < RowEnd; m++)
+    {
+        int32 MirrorRow = (N - m) % N;
+        int32 kyIndex = OceanFFT::SignedFrequency(m, N);
+        float ky = (2.0f * PI * kyIndex) / Settings.OceanSize;
+
+        // Nyquist 那一行 (列) 的 -k 就是它自己，求导后不再共轭对称，导数通道置零 (只有 N 为偶数时存在)
+        bool bEvenSize = (N % 2 == 0);
+        float DerivKy = (bEvenSize && m == N / 2) ? 0.0f : ky;
+
+        for (int32 n = 0; n < N; n++)
+        {
+            int32 kxIndex = OceanFFT::SignedFrequency(n, N);
+            float kx = (2.0f * PI * kxIndex) / Settings.OceanSize;
+            float DerivKx = (bEvenSize && n == N / 2) ? 0.0f : kx;
+
+            // kx >= 0 的一半直接读，另一半用共轭对称 h(k) = conj(h(-k))
+            int32 HalfIndex = (n < HalfSize) ? (m * HalfSize + n) : (MirrorRow * HalfSize + (N - n));
+            float HRe = h_tilde_t.Re[HalfIndex];
+            float HIm = (n < HalfSize) ? h_tilde_t.Im[HalfIndex] : -h_tilde_t.Im[HalfIndex];
+
+            // |k| 查表 (k 与 -k 的模相同)，直流分量不做位移
+            float kMag = KMagTable[HalfIndex];
+            float InvKMag = (kMag > 0.0f) ? 1.0f / kMag : 0.0f;
+
+            // i * a * h = (-a * HIm) + i * (a * HRe)
+            float DispXRe = -DerivKx * InvKMag * HIm,  DispXIm = DerivKx * InvKMag * HRe;
+            float DispYRe = -DerivKy * InvKMag * HIm,  DispYIm = DerivKy * InvKMag * HRe;
+            float SlopeXRe = -DerivKx * HIm,           SlopeXIm = DerivKx * HRe;
+
+            // A + i*B = (ARe - BIm) + i*(AIm + BRe)
+            int32 Index = m * N + n;
+            PackedHeightDispX.Re[Index] = HRe - DispXIm;
+            PackedHeightDispX.Im[Index] = HIm + DispXRe;
+            PackedDispYSlopeX.Re[Index] = DispYRe - SlopeXIm;
+            PackedDispYSlopeX.Im[Index] = DispYIm + SlopeXRe;
+
+            if (n < HalfSize)
+            {
+                SlopeYSpectrum.Re[m * HalfSize + n] = -DerivKy * HIm;
+                SlopeYSpectrum.Im[m * HalfSize + n] = DerivKy * HRe;
+            }
+        }
+    }
+}
+
+
+float FOceanSpectrumSimulation::CalculatePhillips(FVector2D k) const
+{
+    float kLength = k.Size();
+    if (kLength < 0.000001f) return 0.0f; // 避免除以 0
+
+    float kLength2 = kLength * kLength;
+    float kLength4 = kLength2 * kLength2;
+
+    // L_constant = v^2 / g
+    float L_constant = (Settings.WindSpeed * Settings.WindSpeed) / 9.81f;
+    float L2 = L_constant * L_constant;
+
+    // 方向性因子：波浪方向与风向的夹角
+    FVector2D WindDir = Settings.WindDirection;
+    WindDir.Normalize();
+    FVector2D kDir = k;
+    kDir.Normalize();
+    float dot = FVector2D::DotProduct(kDir, WindDir);
+    float dot2 = dot * dot;
+
+    // Phillips 公式核心实现
+    return Settings.Amplitude * (FMath::Exp(-1.0f / (kLength2 * L2)) / kLength4) * dot2;
+}
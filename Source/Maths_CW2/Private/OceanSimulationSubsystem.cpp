@@ -0,0 +1,68 @@
+#include "OceanSimulationSubsystem.h"
+
+
+TSharedRef<FOceanSpectrumSimulation> UOceanSimulationSubsystem::AcquireSimulation(const FOceanSpectrumSettings& Settings)
+{
+    // 已经有同样参数的模拟：直接共用，否则新建
+    if (TSharedPtr<FOceanSpectrumSimulation> Existing = FindSimulation(Settings))
+    {
+        return Existing.ToSharedRef();
+    }
+    return RegisterSimulation(MakeShared<FOceanSpectrumSimulation>(Settings));
+}
+
+
+TSharedPtr<FOceanSpectrumSimulation> UOceanSimulationSubsystem::FindSimulation(const FOceanSpectrumSettings& Settings) const
+{
+    if (const TWeakPtr<FOceanSpectrumSimulation>* Existing = Simulations.Find(Settings))
+    {
+        return Existing->Pin();
+    }
+    return nullptr;
+}
+
+
+TSharedRef<FOceanSpectrumSimulation> UOceanSimulationSubsystem::RegisterSimulation(const TSharedRef<FOceanSpectrumSimulation>& Simulation)
+{
+    // 1. 同样参数的模拟已经有了：用已有的
+    const FOceanSpectrumSettings& Settings = Simulation->GetSettings();
+    if (TSharedPtr<FOceanSpectrumSimulation> Existing = FindSimulation(Settings))
+    {
+        return Existing.ToSharedRef();
+    }
+
+    // 2. 顺便清掉已经没人用的条目
+    for (auto It = Simulations.CreateIterator(); It; ++It)
+    {
+        if (!It.Value().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    // 3. 登记
+    Simulations.Add(Settings, Simulation);
+
+    UE_LOG(LogTemp, Log, TEXT("Ocean simulation created: N = %d, size = %.1f (%d active)."), Settings.N, Settings.OceanSize, Simulations.Num());
+    return Simulation;
+}
+
+
+int32 UOceanSimulationSubsystem::GetNumSimulations() const
+{
+    int32 Count = 0;
+    for (const TPair<FOceanSpectrumSettings, TWeakPtr<FOceanSpectrumSimulation>>& Pair : Simulations)
+    {
+        if (Pair.Value.IsValid()) Count++;
+    }
+    return Count;
+}
+
+
+void UOceanSimulationSubsystem::Deinitialize()
+{
+    // 模拟由 Actor 持有，这里只丢掉索引
+    Simulations.Empty();
+
+    Super::Deinitialize();
+}
@@ -0,0 +1,99 @@
+#include "OceanFFT.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OceanFFTTest
+{
+    // 朴素的 O(N^2) 逆 DFT (双精度)：x[n] = sum X[k] * e^(i*2*PI*k*n/N)，不做 1/N 归一化
+    static void NaiveInverse(const TArray<float>& InRe, const TArray<float>& InIm, TArray<double>& OutRe, TArray<double>& OutIm)
+    {
+        const int32 N = InRe.Num();
+        OutRe.SetNumZeroed(N);
+        OutIm.SetNumZeroed(N);
+        for (int32 n = 0; n < N; n++)
+        {
+            for (int32 k = 0; k < N; k++)
+            {
+                // k*n 先对 N 取模，避免大 N 时角度的精度损失
+                const double Angle = 2.0 * UE_DOUBLE_PI * (double)(((int64)k * n) % N) / N;
+                const double C = FMath::Cos(Angle);
+                const double S = FMath::Sin(Angle);
+                OutRe[n] += InRe[k] * C - InIm[k] * S;
+                OutIm[n] += InRe[k] * S + InIm[k] * C;
+            }
+        }
+    }
+
+    // 用 Plan 做一次逆变换 (指定 SIMD / 标量)，返回相对于结果最大幅值的最大误差
+    static double MaxRelativeError(const FOceanFFTPlan& Plan, const TArray<float>& InRe, const TArray<float>& InIm, const TArray<double>& RefRe, const TArray<double>& RefIm, bool bSIMD)
+    {
+        const int32 N = Plan.GetSize();
+        FOceanAlignedFloatArray Re, Im, Work;
+        Re.SetNumUninitialized(N);
+        Im.SetNumUninitialized(N);
+        Work.SetNumZeroed(FMath::Max(Plan.GetWorkSize(), 1));
+        FMemory::Memcpy(Re.GetData(), InRe.GetData(), N * sizeof(float));
+        FMemory::Memcpy(Im.GetData(), InIm.GetData(), N * sizeof(float));
+
+        Plan.InverseInPlace(Re.GetData(), Im.GetData(), Work.GetData(), bSIMD);
+
+        double MaxError = 0.0;
+        double MaxMagnitude = 1.e-12;
+        for (int32 n = 0; n < N; n++)
+        {
+            MaxError = FMath::Max(MaxError, FMath::Abs(Re[n] - RefRe[n]));
+            MaxError = FMath::Max(MaxError, FMath::Abs(Im[n] - RefIm[n]));
+            MaxMagnitude = FMath::Max(MaxMagnitude, FMath::Max(FMath::Abs(RefRe[n]), FMath::Abs(RefIm[n])));
+        }
+        return MaxError / MaxMagnitude;
+    }
+}
+
+// SIMD 和标量蝶形都要和朴素 DFT 一致：radix-2 (8..1024)、混合基 (2/3/5 因子) 和 Bluestein (其他长度)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOceanFFTSIMDMatchesScalarTest, "Maths_CW2.Ocean.FFT.SIMDMatchesScalar",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOceanFFTSIMDMatchesScalarTest::RunTest(const FString& Parameters)
+{
+    TArray<int32> Sizes;
+    for (int32 Size = 8; Size <= 1024; Size *= 2)
+    {
+        Sizes.Add(Size);
+    }
+    Sizes.Append({ 6, 12, 60, 100, 120, 360, 750 });   // 混合基
+    Sizes.Append({ 7, 13, 97, 127, 509 });             // Bluestein
+
+    // float 的 FFT 误差约为 log2(N) * 1e-7 量级，Bluestein 多两次变换，留足余量
+    const double Tolerance = 1.e-4;
+
+    FRandomStream Random(4242);
+    for (const int32 Size : Sizes)
+    {
+        FOceanFFTPlan Plan(Size);
+        if (!TestTrue(FString::Printf(TEXT("Plan for size %d is valid"), Size), Plan.IsValid()))
+        {
+            continue;
+        }
+
+        TArray<float> InRe, InIm;
+        for (int32 k = 0; k < Size; k++)
+        {
+            InRe.Add(Random.FRandRange(-1.0f, 1.0f));
+            InIm.Add(Random.FRandRange(-1.0f, 1.0f));
+        }
+
+        TArray<double> RefRe, RefIm;
+        OceanFFTTest::NaiveInverse(InRe, InIm, RefRe, RefIm);
+
+        const double ScalarError = OceanFFTTest::MaxRelativeError(Plan, InRe, InIm, RefRe, RefIm, false);
+        const double SIMDError = OceanFFTTest::MaxRelativeError(Plan, InRe, InIm, RefRe, RefIm, true);
+        TestTrue(FString::Printf(TEXT("Scalar FFT of size %d matches the naive DFT (error %g)"), Size, ScalarError), ScalarError < Tolerance);
+        TestTrue(FString::Printf(TEXT("SIMD FFT of size %d matches the naive DFT (error %g)"), Size, SIMDError), SIMDError < Tolerance);
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
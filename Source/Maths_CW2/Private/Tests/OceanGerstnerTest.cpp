@@ -0,0 +1,121 @@
+#include "OceanGerstner.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OceanGerstnerTest
+{
+    // 随机的一组波浪 (SoA)，和 FGerstnerWaveTable 一样按分量存放
+    struct FWaveSet
+    {
+        FOceanAlignedFloatArray K, DirX, DirY, Amplitude, Steepness, Phase;
+
+        FWaveSet(int32 NumWaves, float MinWavelength, float MaxWavelength, int32 Seed)
+        {
+            FRandomStream Random(Seed);
+            for (int32 w = 0; w < NumWaves; w++)
+            {
+                const float Wavelength = Random.FRandRange(MinWavelength, MaxWavelength);
+                const float Angle = Random.FRandRange(0.0f, 2.0f * PI);
+                K.Add(2.0f * PI / Wavelength);
+                DirX.Add(FMath::Cos(Angle));
+                DirY.Add(FMath::Sin(Angle));
+                Amplitude.Add(Wavelength * 0.01f);
+                Steepness.Add(Random.FRandRange(0.0f, 0.2f));
+                Phase.Add(Random.FRandRange(0.0f, 100.0f));
+            }
+        }
+
+        FOceanGerstnerWaves GetView() const
+        {
+            FOceanGerstnerWaves Waves;
+            Waves.Num = K.Num();
+            Waves.K = K.GetData();
+            Waves.DirX = DirX.GetData();
+            Waves.DirY = DirY.GetData();
+            Waves.Amplitude = Amplitude.GetData();
+            Waves.Steepness = Steepness.GetData();
+            Waves.Phase = Phase.GetData();
+            return Waves;
+        }
+    };
+
+    // 一行的结果
+    struct FRow
+    {
+        TArray<FVector3f> Positions;
+        TArray<FOceanMeshTangent> Tangents;
+
+        explicit FRow(int32 Count)
+        {
+            Positions.SetNumUninitialized(Count);
+            Tangents.SetNumUninitialized(Count);
+        }
+    };
+}
+
+// 所有 Gerstner 内核 (SIMD、标量递推、SIMD 递推) 都要和标量参考实现一致
+// 行宽包括不是 4 的倍数的情况 (SIMD 的尾巴走标量) 和比一组 SIMD 还短的行
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOceanGerstnerKernelsMatchScalarTest, "Maths_CW2.Ocean.Gerstner.KernelsMatchScalar",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOceanGerstnerKernelsMatchScalarTest::RunTest(const FString& Parameters)
+{
+    using namespace OceanGerstnerTest;
+
+    // 位置的容差：递推在一行里累积的误差约为 1e-4 * 振幅之和；法线打包成 8 位，量化误差约 1/127
+    const float PositionTolerance = 0.01f;
+    const float NormalTolerance = 0.03f;
+
+    const FWaveSet WaveSet(64, 10.0f, 600.0f, 2024);
+    const FOceanGerstnerWaves Waves = WaveSet.GetView();
+
+    FOceanAlignedFloatArray Scratch;
+    Scratch.SetNumUninitialized(OceanGerstner::GetRowScratchSize(Waves.Num));
+
+    const float Step = 3.9f;
+    for (const int32 Count : { 1, 3, 7, 64, 515 })
+    {
+        for (int32 Row = 0; Row < 4; Row++)
+        {
+            const float X0 = -100.0f + Row * 37.0f;
+            const float Y = Row * 7.8f;
+
+            FRow Reference(Count);
+            OceanGerstner::EvaluateRowScalar(Waves, X0, Step, Y, Count, Reference.Positions.GetData(), Reference.Tangents.GetData());
+
+            FRow SIMD(Count), RecurrenceScalar(Count), RecurrenceSIMD(Count);
+            OceanGerstner::EvaluateRowSIMD(Waves, X0, Step, Y, Count, SIMD.Positions.GetData(), SIMD.Tangents.GetData());
+            OceanGerstner::EvaluateRowRecurrenceScalar(Waves, X0, Step, Y, Count, RecurrenceScalar.Positions.GetData(), RecurrenceScalar.Tangents.GetData(), Scratch.GetData());
+            OceanGerstner::EvaluateRowRecurrenceSIMD(Waves, X0, Step, Y, Count, RecurrenceSIMD.Positions.GetData(), RecurrenceSIMD.Tangents.GetData(), Scratch.GetData());
+
+            const TPair<const TCHAR*, const FRow*> Kernels[] =
+            {
+                { TEXT("SIMD"), &SIMD },
+                { TEXT("Recurrence scalar"), &RecurrenceScalar },
+                { TEXT("Recurrence SIMD"), &RecurrenceSIMD },
+            };
+
+            for (const TPair<const TCHAR*, const FRow*>& Kernel : Kernels)
+            {
+                float PositionError = 0.0f;
+                float NormalError = 0.0f;
+                for (int32 n = 0; n < Count; n++)
+                {
+                    PositionError = FMath::Max(PositionError, (Kernel.Value->Positions[n] - Reference.Positions[n]).GetAbsMax());
+                    const FVector3f Normal = Kernel.Value->Tangents[n].TangentZ.ToFVector3f();
+                    const FVector3f ReferenceNormal = Reference.Tangents[n].TangentZ.ToFVector3f();
+                    NormalError = FMath::Max(NormalError, (Normal - ReferenceNormal).GetAbsMax());
+                }
+
+                TestTrue(FString::Printf(TEXT("%s positions match the scalar kernel (count %d, row %d, error %g)"), Kernel.Key, Count, Row, PositionError), PositionError < PositionTolerance);
+                TestTrue(FString::Printf(TEXT("%s normals match the scalar kernel (count %d, row %d, error %g)"), Kernel.Key, Count, Row, NormalError), NormalError < NormalTolerance);
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
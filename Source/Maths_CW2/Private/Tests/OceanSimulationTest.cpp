@@ -0,0 +1,149 @@
+#include "OceanSimulation.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include <atomic>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OceanSimulationTest
+{
+    // 包一层 GMalloc，只统计指定线程上的 Malloc / Realloc 次数 (其他线程照常分配，不计数)
+    class FCountingMalloc final : public FMalloc
+    {
+    public:
+        FCountingMalloc(FMalloc* InInner, uint32 InThreadId) : Inner(InInner), ThreadId(InThreadId) {}
+
+        virtual void* Malloc(SIZE_T Size, uint32 Alignment) override
+        {
+            Count();
+            return Inner->Malloc(Size, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Size, uint32 Alignment) override
+        {
+            Count();
+            return Inner->Realloc(Original, Size, Alignment);
+        }
+
+        virtual void Free(void* Original) override
+        {
+            Inner->Free(Original);
+        }
+
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+        {
+            return Inner->GetAllocationSize(Original, SizeOut);
+        }
+
+        virtual bool IsInternallyThreadSafe() const override
+        {
+            return Inner->IsInternallyThreadSafe();
+        }
+
+        virtual const TCHAR* GetDescriptiveName() override
+        {
+            return TEXT("OceanCountingMalloc");
+        }
+
+        int32 GetCount() const { return Allocations.load(); }
+
+    private:
+        FMalloc* Inner;
+        uint32 ThreadId;
+        std::atomic<int32> Allocations { 0 };
+
+        void Count()
+        {
+            if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+            {
+                Allocations++;
+            }
+        }
+    };
+
+    // 在 Body 执行期间把 GMalloc 换成计数的版本，返回当前线程上的分配次数
+    template <typename BodyType>
+    static int32 CountAllocations(const BodyType& Body)
+    {
+        FMalloc* Previous = GMalloc;
+        FCountingMalloc Counting(Previous, FPlatformTLS::GetCurrentThreadId());
+        GMalloc = &Counting;
+        Body();
+        GMalloc = Previous;
+        return Counting.GetCount();
+    }
+}
+
+// 预热之后每帧的演化 + IFFT (完整模拟和分时模拟) 不应再有任何堆分配
+// 单线程运行 (ParallelFor 在当前线程内联执行)，只统计当前线程的分配
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOceanSimulationNoHeapAllocationTest, "Maths_CW2.Ocean.Simulation.NoHeapAllocationPerTick",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOceanSimulationNoHeapAllocationTest::RunTest(const FString& Parameters)
+{
+    // 分时模式每帧只算一块：正在计算的关键帧第一次做变换时才分配 FFT 的临时缓冲，所以预热和统计都要覆盖完整的关键帧
+    const int32 NumWarmUpTicks = 128;
+    const int32 NumTicks = 128;
+    const float DeltaTime = 1.0f / 60.0f;
+
+    FOceanFFTParallelSettings Parallel;
+    Parallel.NumThreads = 1;
+
+    FOceanTimeSliceSettings TimeSlice;
+    TimeSlice.bEnabled = true;
+    TimeSlice.BudgetMs = 0.0f; // 每帧只算一块，关键帧的各个步骤都会走到
+    TimeSlice.RowsPerChunk = 8;
+
+    // 2 的幂 / 混合基，以及打开 Nyquist 裁剪 (跳过全零的行和列) 的情况
+    for (const int32 N : { 64, 100 })
+    {
+        for (const float CutoffWavelength : { 0.0f, 62.5f })
+        {
+            FOceanSpectrumSettings Settings;
+            Settings.N = N;
+            Settings.CutoffWavelength = CutoffWavelength;
+            FOceanSpectrumSimulation Simulation(Settings);
+
+            FOceanFFTWorkspace Workspace;
+            Workspace.Resize(N);
+            FOceanFFTWorkspace SlicedOutput;
+            SlicedOutput.Resize(N);
+
+            // 1. 预热：FFT 的临时缓冲和分时模式的关键帧在第一次用到时分配
+            float Time = 0.0f;
+            for (int32 Tick = 0; Tick < NumWarmUpTicks; Tick++, Time += DeltaTime)
+            {
+                Simulation.Run(Time, Parallel, Workspace);
+                Simulation.RunTimeSliced(Time, Parallel, TimeSlice, Tick == 0, true, SlicedOutput);
+            }
+
+            // 2. 之后每帧都不应分配
+            const int32 RunAllocations = OceanSimulationTest::CountAllocations([&]()
+            {
+                for (int32 Tick = 0; Tick < NumTicks; Tick++)
+                {
+                    Simulation.Run(Time + Tick * DeltaTime, Parallel, Workspace);
+                }
+            });
+
+            const int32 SlicedAllocations = OceanSimulationTest::CountAllocations([&]()
+            {
+                for (int32 Tick = 0; Tick < NumTicks; Tick++)
+                {
+                    Simulation.RunTimeSliced(Time + Tick * DeltaTime, Parallel, TimeSlice, false, true, SlicedOutput);
+
+                    // 同一帧里异步 Actor 请求的 t + dt 只插值
+                    Simulation.RunTimeSliced(Time + (Tick + 1) * DeltaTime, Parallel, TimeSlice, false, false, SlicedOutput);
+                }
+            });
+
+            TestEqual(FString::Printf(TEXT("Run allocations over %d ticks (N = %d, cutoff %.1f)"), NumTicks, N, CutoffWavelength), RunAllocations, 0);
+            TestEqual(FString::Printf(TEXT("RunTimeSliced allocations over %d ticks (N = %d, cutoff %.1f)"), NumTicks, N, CutoffWavelength), SlicedAllocations, 0);
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
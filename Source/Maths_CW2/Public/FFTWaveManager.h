@@ -1,12 +1,48 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
-#include <complex> // ļ
-#include <vector>
-#include "ProceduralMeshComponent.h"
+#include "OceanMeshComponent.h"
+#include "OceanQuadtree.h"
+#include "OceanClipmap.h"
+#include "OceanSimulation.h"
+#include "OceanResolutionController.h"
+#include "Tasks/Task.h"
+#include <atomic>
 #include "FFTWaveManager.generated.h" //must be the last include
 
-typedef std::complex<float> Complex;
+// 海面网格的生成方式
+UENUM(BlueprintType)
+enum class EOceanMeshMode : uint8
+{
+    // 一块 OceanSize x OceanSize 的网格，分辨率就是 MeshResolution
+    SingleTile,
+
+    // CDLOD 四叉树：近处密、远处疏的多块网格，平铺同一块周期性海面，覆盖 SeaSize 大小的海域
+    Quadtree,
+
+    // Geometry Clipmap：以相机为中心的一圈圈环形网格，顶点数固定，与海域大小无关
+    Clipmap,
+};
+
+// 一帧网格的参数快照 (后台任务只读这份拷贝，不直接读 UPROPERTY)
+// 海面本身由共享的模拟计算，这里只有这个 Actor 自己怎么摆网格、怎么采样
+struct FOceanFFTFrameSettings
+{
+    int32 N = 0;
+    float OceanSize = 0.0f;
+    float Choppiness = 0.0f;
+
+    EOceanMeshMode MeshMode = EOceanMeshMode::SingleTile;
+
+    // 四叉树模式：相机位置 (Actor 本地坐标) 和选好的网格块 (游戏线程在启动任务之前写好，任务期间不变)
+    FOceanQuadtreeSettings Quadtree;
+    FVector3f ViewPosition = FVector3f::ZeroVector;
+    const TArray<FOceanQuadtreePatch>* QuadtreePatches = nullptr;
+
+    // Clipmap 模式：每一层的位置 (同样由游戏线程写好)
+    FOceanClipmapSettings Clipmap;
+    const TArray<FOceanClipmapLevel>* ClipmapLevels = nullptr;
+};
 
 UCLASS()
 class MATHS_CW2_API AFFTWaveManager : public AActor
@@ -21,60 +57,252 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// ׺
-    float CalculatePhillips(FVector2D k);
+    // 结束时等待后台模拟任务
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-    // --- ￪ʼӲ˲ ---
+    // --- 在这里开始添加波浪参数 ---
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    int32 MeshResolution = 64; // FFT ֱ (N)
+    int32 MeshResolution = 64; // FFT 分辨率 (N)
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    float OceanSize = 1000.0f; // ߴ (L)
+    float OceanSize = 1000.0f; // 海洋物理尺寸 (L)
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    float TimeScale = 1.0f; // ʱٿ
+    float TimeScale = 1.0f; // 时间流速控制
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    float Amplitude = 1.0f; // ճ (A)
+    float Amplitude = 1.0f; // 菲利普常数 (A)
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    FVector2D WindDirection = FVector2D(1.0f, 1.0f); // 
+    FVector2D WindDirection = FVector2D(1.0f, 1.0f); // 风向
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
-    float WindSpeed = 20.0f; // 
+    float WindSpeed = 20.0f; // 风速
+
+    UPROPERTY(EditAnywhere, Category = "Wave Settings", meta = (ClampMin = "0.0"))
+    float Choppiness = 1.5f; // 水平位移强度 (浪尖变尖)
 
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
     UMaterialInterface* OceanMaterial;
 
-    // 洢ʼƵݺĹں FFT 㣩
-    //std::vector<Complex> h0_tilde;
-    //std::vector<Complex> h0_tilde_conj;
-    TArray<Complex> h0_tilde;
-    TArray<Complex> h0_tilde_conj;
-    
-    //ѵ
-    // 1. ӻ
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-    UProceduralMeshComponent* OceanMesh;
+    // --- 多线程 FFT 设置 ---
+
+    // 参与 FFT 的线程数 (0 = 自动使用全部工作线程，1 = 单线程，用来测量多核加速比)
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0"))
+    int32 FFTThreadCount = 0;
+
+    // 每个任务块至少处理的行 (列) 数
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "1"))
+    int32 FFTMinBatchSize = 8;
+
+    // --- 网格 LOD ---
+
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD")
+    EOceanMeshMode MeshMode = EOceanMeshMode::SingleTile;
+
+    // 四叉树覆盖的海域边长 (以 Actor 为中心)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "1.0", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    float SeaSize = 32000.0f;
 
-    // 2. ݻ棨뱣ΪԱΪ Tick ÿһ֡Ҫ޸
-    TArray<FVector> Vertices;
-    TArray<int32> Triangles;
-    TArray<FVector2D> UVs;
-    TArray<FVector> Normals;
-    TArray<FProcMeshTangent> Tangents;
-    TArray<FColor> Colors;
+    // LOD 层数：最近一层网格块的边长 = SeaSize / 2^(层数-1)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "1", ClampMax = "16", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    int32 QuadtreeLevels = 7;
+
+    // 每块网格的格子数 (4 的倍数，其他值会向下取整)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "4", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    int32 PatchResolution = 16;
+
+    // 最近一层的可见距离，之后每层翻倍 (太小会自动放大，保证相邻两层之间没有裂缝)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "0.0", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    float LOD0Range = 1000.0f;
+
+    // 每层距离范围内从这个比例开始向下一层过渡 (Geomorphing)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "0.0", ClampMax = "0.95", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    float MorphStartRatio = 0.7f;
+
+    // 最多同时显示的网格块数 (决定顶点缓冲的大小)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "1", EditCondition = "MeshMode == EOceanMeshMode::Quadtree"))
+    int32 MaxPatches = 192;
+
+    // Clipmap 的层数：每一层格子大一倍，覆盖范围也大一倍
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "1", ClampMax = "16", EditCondition = "MeshMode == EOceanMeshMode::Clipmap"))
+    int32 ClipmapLevels = 8;
+
+    // 每块网格的格子数 (偶数)，一层由 4 x 4 块组成
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "2", EditCondition = "MeshMode == EOceanMeshMode::Clipmap"))
+    int32 ClipmapBlockResolution = 16;
+
+    // 最里面一层的格子大小
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "0.01", EditCondition = "MeshMode == EOceanMeshMode::Clipmap"))
+    float ClipmapCellSize = 16.0f;
+
+    // 每层半径的这个比例开始向外层过渡 (Geomorphing)
+    UPROPERTY(EditAnywhere, Category = "Mesh LOD", meta = (ClampMin = "0.55", ClampMax = "0.95", EditCondition = "MeshMode == EOceanMeshMode::Clipmap"))
+    float ClipmapMorphStartRatio = 0.7f;
+
+    // 异步模拟：在后台提前一帧计算 t+dt，Tick 只提交上一帧算好的结果
+    // (关掉则在 Tick 里同步计算，方便对比和调试)
+    UPROPERTY(EditAnywhere, Category = "Performance")
+    bool bAsyncSimulation = true;
+
+    // 分时更新：FFT 按行分块，每帧只在预算内算一部分，显示的海面在最近两个算好的关键帧之间插值
+    // (海面会比实际时间晚一个关键帧间隔左右，换来每帧稳定的开销)
+    UPROPERTY(EditAnywhere, Category = "Performance")
+    bool bTimeSlicedSimulation = false;
+
+    // 每帧给模拟的时间预算 (毫秒)，至少会算一块
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0.0", EditCondition = "bTimeSlicedSimulation"))
+    float TimeSliceBudgetMs = 1.0f;
+
+    // 每一块处理的行 (列) 数
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "1", EditCondition = "bTimeSlicedSimulation"))
+    int32 TimeSliceRowsPerChunk = 8;
+
+    // 自适应分辨率：按每帧的实际开销自动升降 MeshResolution
+    UPROPERTY(EditAnywhere, Category = "Performance")
+    FOceanAdaptiveResolutionSettings AdaptiveResolution;
+
+    // Nyquist 裁剪：波长短于 2 倍网格格子 (四叉树 / Clipmap 取最密一层) 的频点置零，网格画不出这些波，只会混叠
+    // 全零的行 (列) 不做演化和变换。只在网格比 FFT 的格点 (OceanSize / MeshResolution) 稀时生效，单块模式不受影响
+    UPROPERTY(EditAnywhere, Category = "Performance")
+    bool bCullAboveNyquist = true;
+
+    // 淡出区间的宽度 (截止波长的比例)
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0.0", EditCondition = "bCullAboveNyquist"))
+    float NyquistFadeWidth = 0.5f;
+
+    //把点连成面
+    // 1. 可视化的网格组件
+    // (UV 和索引由组件在 InitializeGrid 时生成，每帧只更新位置和切线)
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    UOceanMeshComponent* OceanMesh;
 
-    // ĳʼ״
+    // 辅助函数：生成网格的初始形状
     void GenerateGrid();
 
-	//IFFT غ
-    void PerformIDFT_Row(int32 RowIndex, const TArray<Complex>& Input, TArray<Complex>& Output);
-    void PerformIDFT_Col(int32 ColIndex, const TArray<Complex>& Input, TArray<Complex>& Output);
+	//IFFT 相关
+    // 频谱、FFT 计划和结果缓冲都在共享的模拟里 (UOceanSimulationSubsystem 按参数共用)
+    // 这个 Actor 只是一个视图：每帧请求一次模拟，再对结果采样生成自己的网格
+    TSharedPtr<FOceanSpectrumSimulation> Simulation;
+
+    // 按当前参数取得共享的模拟 (没有子系统时自己建一份)
+    void AcquireSimulation();
+
+    // 这个分辨率、当前参数下的频谱设置 (共享模拟的查找键)
+    FOceanSpectrumSettings MakeSpectrumSettings(int32 Resolution) const;
+
+    // 这个分辨率下网格最密处的格子大小 (决定 Nyquist 截止波长，按修正之后的四叉树 / Clipmap 设置计算)
+    float GetFinestCellSize(int32 Resolution) const;
+
+    // 由属性生成修正之后的四叉树 / Clipmap 设置 (GenerateGrid 和 Nyquist 截止共用，保证两边一致)
+    FOceanQuadtreeSettings MakeQuadtreeSettings() const;
+    FOceanClipmapSettings MakeClipmapSettings() const;
+
+    // --- 自适应分辨率 ---
+
+    FOceanResolutionController ResolutionController;
+
+    // 后台准备好的新一档：网格拓扑 (单块模式) 和模拟，准备期间继续用旧的分辨率
+    struct FPreparedResolution
+    {
+        int32 Resolution = 0;
+        bool bHasTopology = false;
+        FOceanMeshGridTopology Topology;
+        TSharedPtr<FOceanSpectrumSimulation> Simulation;
+    };
+    TSharedPtr<FPreparedResolution> PreparedResolution;
+    UE::Tasks::FTask PrepareTask;
+
+    // 上一帧生成顶点 (后台任务写) 和提交给组件的耗时 (毫秒)
+    std::atomic<float> LastBuildMs { 0.0f };
+    float LastPublishMs = 0.0f;
+
+    // 统计开销，需要时开始准备新的分辨率，准备好了就切换
+    void UpdateAdaptiveResolution();
+    void StartPrepareResolution(int32 NewResolution);
+    void ApplyPreparedResolution();
+
+    // 放弃正在准备的分辨率 (参数变了，要整个重建)
+    void CancelPreparedResolution();
+
+    // --- 异步模拟 ---
+
+    // 双缓冲的模拟结果：(N+1) x (N+1) 的位置和切线 (GPU 格式)
+    // 后台任务写后缓冲，网格读前缓冲，交换之后两边不会同时访问同一份
+    // BackFrameIndex 指向正在 (或将要) 被写入的那一份
+    FOceanMeshStreams Frames[2];
+    int32 BackFrameIndex = 0;
+
+    // 后台任务是否已经为下一帧写好 (或正在写) 后缓冲
+    bool bHasPendingFrame = false;
+
+    // 生成顶点的后台任务 (以共享模拟这一帧的任务为前置)
+    UE::Tasks::FTask SimulationTask;
+
+    // --- 四叉树 ---
+
+    // 修正后的四叉树设置 (在 GenerateGrid 中确定)
+    FOceanQuadtreeSettings QuadtreeSettings;
+
+    // 当前选中的网格块：只在后台任务结束之后由游戏线程改写
+    TArray<FOceanQuadtreePatch> QuadtreePatches;
+
+    // --- Clipmap ---
+
+    // 修正后的 Clipmap 设置 (在 GenerateGrid 中确定)
+    FOceanClipmapSettings ClipmapSettings;
+
+    // 每一层这一帧的位置：同样只在后台任务结束之后改写
+    TArray<FOceanClipmapLevel> ClipmapLevelInfos;
+
+    // 相机位置 (Actor 本地坐标)，没有玩家相机时用 Actor 自己的位置
+    FVector3f GetLocalViewPosition() const;
+
+    // 对模拟结果采样，生成一帧的顶点写入 OutFrame，可以在后台线程运行
+    void BuildFrame(const FOceanFFTFrameSettings& Settings, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutFrame);
+
+    // 向模拟请求时间 Time 的海面，并启动对结果采样、写入后缓冲的后台任务 (SimulationTask)
+    void LaunchFrame(float Time, const FOceanFFTFrameSettings& Settings, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice);
+
+    // 等待正在运行的后台任务 (换模拟 / 改网格之前必须调用)
+    void WaitForSimulation();
+
+    // 把一帧结果提交给网格组件 (与组件的暂存缓冲交换，Frame 换回一份旧缓冲)
+    void PublishFrame(FOceanMeshStreams& Frame);
+
+    // bSpectrumDirty：影响 h0 的参数改变，需要换一份模拟
+    // bGridDirty：分辨率 / 尺寸改变，需要重建网格 (同时也会换模拟)
+    bool bSpectrumDirty = true;
+    bool bGridDirty = true;
+
+    // 按当前分辨率重建网格并取得模拟
+    void RebuildSimulation();
+
+#if WITH_EDITOR
+    // 编辑器里改参数时标记缓存失效
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+    // --- 运行时修改参数 (蓝图可调用)，只在值真正变化时让频谱缓存失效 ---
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetWindSpeed(float NewWindSpeed);
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetWindDirection(FVector2D NewWindDirection);
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetAmplitude(float NewAmplitude);
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetOceanSize(float NewOceanSize);
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetMeshResolution(int32 NewMeshResolution);
+
 };
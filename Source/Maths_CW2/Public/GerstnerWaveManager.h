@@ -2,34 +2,57 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
-#include "ProceduralMeshComponent.h"
+#include "OceanMeshComponent.h"
+#include "OceanFFT.h"
+#include "OceanGerstner.h"
+#include "OceanResolutionController.h"
+#include "Tasks/Task.h"
 #include "GerstnerWaveManager.generated.h"
 
-// 嵥˵Ĳṹ
+// 定义单个波浪的参数结构体
 USTRUCT(BlueprintType)
 struct FGerstnerWave
 {
     GENERATED_BODY()
 
-    // ˴ (X, Y)
+    // 波浪传播方向 (X, Y)
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wave Param")
     FVector2D Direction = FVector2D(1.0f, 0.0f);
 
-    //  (Wavelength): ˵Ŀ
+    // 波长 (Wavelength): 决定波浪的宽度
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wave Param")
     float Wavelength = 600.0f;
 
-    //  (Steepness): ˼ж (0~1)ᵼ´
+    // 陡度 (Steepness): 决定浪尖有多尖 (0~1)，过大会导致穿插
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wave Param", meta = (ClampMin = "0.0", ClampMax = "1.0"))
     float Steepness = 0.2f;
 
-    //  (Amplitude): ж
+    // 振幅 (Amplitude): 决定浪有多高
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wave Param")
     float Amplitude = 20.0f;
 
 
 };
 
+// 每个波浪的常量，按分量分开连续存放 (SoA)
+// 只在 Waves 改变时重建 (编辑器改属性 / SetWaves)，每帧的顶点循环里只剩对这几个数组的纯算术
+struct FGerstnerWaveTable
+{
+    FOceanAlignedFloatArray K;          // 波数 k = 2*PI / 波长 (波长至少 10)
+    FOceanAlignedFloatArray Speed;      // 相速度 c = sqrt(g / k)
+    FOceanAlignedFloatArray DirX;       // 归一化的传播方向
+    FOceanAlignedFloatArray DirY;
+    FOceanAlignedFloatArray Amplitude;
+    FOceanAlignedFloatArray Steepness;
+
+    int32 Num() const { return K.Num(); }
+
+    void Build(const TArray<FGerstnerWave>& InWaves);
+
+    // 从 Source 中挑出网格画得出来的波：波长 <= CutoffWavelength 的直接去掉，淡出区间内的振幅乘上权重
+    void BuildVisible(const FGerstnerWaveTable& Source, float CutoffWavelength, float FadeWidth);
+};
+
 UCLASS()
 class MATHS_CW2_API AGerstnerWaveManager : public AActor
 {
@@ -41,41 +64,115 @@ public:
 protected:
     virtual void BeginPlay() override;
 
+#if WITH_EDITOR
+    // 编辑器里改了 Waves 时标记常量表失效
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 public:
     virtual void Tick(float DeltaTime) override;
 
-    // ---  ---
+    // --- 核心组件 ---
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-    UProceduralMeshComponent* OceanMesh;
+    UOceanMeshComponent* OceanMesh;
 
-    // ---  ( FFT һԱԱ) ---
+    // --- 网格设置 (保持与 FFT 一致以便对比) ---
     UPROPERTY(EditAnywhere, Category = "Grid Settings")
     int32 MeshResolution = 64;
 
     UPROPERTY(EditAnywhere, Category = "Grid Settings")
     float OceanSize = 2000.0f;
 
-    // ---  ---
+    // 自适应分辨率：按每帧的实际开销自动升降 MeshResolution
+    UPROPERTY(EditAnywhere, Category = "Grid Settings")
+    FOceanAdaptiveResolutionSettings AdaptiveResolution;
+
+    // --- 多线程 ---
+
+    // 顶点按行分成多少块并行计算 (0 = 自动：按工作线程数，每块至少 8 行；1 = 单线程，用来测量加速比)
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0"))
+    int32 UpdateChunkCount = 0;
+
+    // 波数达到这个值时改用 FFT 合成 (开销和波数无关，波矢吸附到 2*PI/OceanSize 的整数倍)，0 = 始终逐顶点求值
+    // 交叉点可以用控制台命令 ocean.Gerstner.Benchmark 测量
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0"))
+    int32 FFTSynthesisWaveCount = 48;
+
+    // FFT 合成时参与变换的线程数 (0 = 自动使用全部工作线程，1 = 单线程)，和上面按行分块的 UpdateChunkCount 无关
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0", EditCondition = "FFTSynthesisWaveCount > 0"))
+    int32 FFTThreadCount = 0;
+
+    // --- Nyquist 裁剪 ---
+
+    // 跳过波长短于 2 倍格子间距 (OceanSize / 分辨率) 的波：网格画不出来，只会混叠成错误的长波
+    UPROPERTY(EditAnywhere, Category = "Performance")
+    bool bCullAboveNyquist = true;
+
+    // 淡出区间的宽度 (截止波长的比例)：波长在 [截止, 截止 * (1 + 宽度)] 之间的波振幅平滑减小到 0
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "0.0", EditCondition = "bCullAboveNyquist"))
+    float NyquistFadeWidth = 0.5f;
+
+    // --- 波浪设置 ---
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
     float TimeScale = 1.0f;
 
-    //  4  (Ϊ˶Ա FFT ĳǧ)
+    // 定义 4 个基础波浪 (为了对比 FFT 的成千上万个波)
     UPROPERTY(EditAnywhere, Category = "Wave Settings")
     TArray<FGerstnerWave> Waves;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Visuals")
     UMaterialInterface* OceanMaterial;
 
+    // --- 运行时修改波浪 (蓝图可调用)，下一帧重建常量表 ---
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetWaves(const TArray<FGerstnerWave>& NewWaves);
+
+    UFUNCTION(BlueprintCallable, Category = "Wave Settings")
+    void SetWave(int32 Index, const FGerstnerWave& NewWave);
+
 private:
-    // 
-    TArray<FVector> Vertices;
-    TArray<int32> Triangles;
-    TArray<FVector> Normals;
-    TArray<FVector2D> UVs;
-    TArray<FColor> Colors;
-    TArray<FProcMeshTangent> Tangents;
-
-    // 
+    // 网格数据：位置和切线直接按 GPU 格式写 (UV 和索引由组件生成)
+    FOceanMeshStreams Streams;
+
+    // 当前网格的分辨率 (GenerateGrid / 切换分辨率时确定)，基础位置 = (n, m) * OceanSize / GridResolution
+    int32 GridResolution = 1;
+
+    // 波浪常量表 (Waves 改变之后在下一次 UpdateWaves 里重建)
+    FGerstnerWaveTable WaveTable;
+    bool bWaveTableDirty = true;
+
+    // 当前网格实际参与计算的波 (按 Nyquist 裁剪之后)，以及它对应的截止波长和淡出宽度 (变化时重建)
+    FGerstnerWaveTable VisibleWaves;
+    float VisibleCutoff = -1.0f;
+    float VisibleFadeWidth = -1.0f;
+
+    // 每帧每个波只算一次的相位 k*c*t
+    FOceanAlignedFloatArray WavePhases;
+
+    // 相位递推的临时状态，每个任务块一份 (见 OceanGerstner::GetRowScratchSize)
+    FOceanAlignedFloatArray KernelScratch;
+
+    // 波数很多时的 FFT 合成 (分辨率或 OceanSize 变化后在下一次 UpdateWaves 里重建)
+    FOceanGerstnerSpectrum Spectrum;
+
+    // 辅助函数
     void GenerateGrid();
     void UpdateWaves(float Time);
+
+    // --- 自适应分辨率 ---
+
+    FOceanResolutionController ResolutionController;
+
+    // 后台准备好的新一档网格拓扑，准备期间继续用旧的分辨率
+    struct FPreparedResolution
+    {
+        int32 Resolution = 0;
+        FOceanMeshGridTopology Topology;
+    };
+    TSharedPtr<FPreparedResolution> PreparedResolution;
+    UE::Tasks::FTask PrepareTask;
+
+    // 记录这一帧的开销 (计算 + 提交)，需要时开始准备新的分辨率，准备好了就切换
+    void UpdateAdaptiveResolution(float CostMs);
 };
\ No newline at end of file
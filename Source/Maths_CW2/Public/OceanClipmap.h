@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanMeshComponent.h"
+#include "OceanSurfaceSampler.h"
+
+// 以相机为中心的嵌套环形网格 (Geometry Clipmap)
+// 第 0 层是一整块网格，之后每一层格子大一倍、中间挖掉上一层所在的区域，一圈圈向外扩展
+// 网格的拓扑在启动时建好以后不再改变，每帧只按相机位置 (对齐到格点) 平移并对海面采样，
+// 所以顶点数是固定的，与海域大小无关
+//
+// 每一层由 4 x 4 块同样大小的网格块组成 (环形的层去掉中间 2 x 2 块)，每块 BlockResolution 个格子
+struct FOceanClipmapSettings
+{
+    int32 NumLevels = 8;          // 层数
+    int32 BlockResolution = 16;   // 每块网格的格子数，一层的边长是 4 倍
+    float BaseCellSize = 16.0f;   // 第 0 层的格子大小
+    float MorphStartRatio = 0.7f; // 从每层半径的这个比例开始向外层的格子过渡 (Geomorphing)
+
+    int32 GetLevelResolution() const { return 4 * BlockResolution; }
+    int32 GetVertsPerBlock() const { return (BlockResolution + 1) * (BlockResolution + 1); }
+    int32 GetNumBlocks() const { return 16 + 12 * (NumLevels - 1); }
+    float GetCellSize(int32 Level) const { return BaseCellSize * (float)(1 << Level); }
+};
+
+// 一层在这一帧的摆放
+struct FOceanClipmapLevel
+{
+    FVector2f Origin = FVector2f::ZeroVector; // 左下角 (本地坐标)，对齐到 2 倍格子大小
+    float CellSize = 0.0f;
+
+    // 中间挖空的区域相对标准位置偏移的格子数 (0 或 1)
+    // 内层和外层各自对齐，内层在洞里的位置会差一个外层格子，把洞边上的一圈格点平移过去就能严丝合缝
+    int32 HoleShiftX = 0;
+    int32 HoleShiftY = 0;
+};
+
+namespace OceanClipmap
+{
+    // 修正不合法的设置
+    MATHS_CW2_API FOceanClipmapSettings Sanitize(const FOceanClipmapSettings& Settings);
+
+    // 按相机位置 (本地坐标) 计算每一层的位置
+    MATHS_CW2_API void UpdateLevels(const FOceanClipmapSettings& Settings, const FVector3f& ViewPosition, TArray<FOceanClipmapLevel>& OutLevels);
+
+    // 所有层覆盖的范围 (平面)
+    MATHS_CW2_API FBox GetBounds(const FOceanClipmapSettings& Settings, const TArray<FOceanClipmapLevel>& Levels);
+
+    // 生成所有网格块的顶点：外圈按距离做 Geomorphing，再对海面采样
+    MATHS_CW2_API void BuildVertices(const FOceanClipmapSettings& Settings, const TArray<FOceanClipmapLevel>& Levels, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutStreams);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 实部和虚部分开存放 (SoA)，按 64 字节对齐，SIMD 可以连续读写 4 个实部 / 4 个虚部
+// std::complex 是交错存放 (AoS) 的，复数乘法很难向量化
+typedef TArray<float, TAlignedHeapAllocator<64>> FOceanAlignedFloatArray;
+
+struct FOceanComplexArray
+{
+    FOceanAlignedFloatArray Re;
+    FOceanAlignedFloatArray Im;
+
+    int32 Num() const { return Re.Num(); }
+
+    void SetNumZeroed(int32 Count)
+    {
+        Re.SetNumZeroed(Count);
+        Im.SetNumZeroed(Count);
+    }
+
+    // 只在变大时重新分配
+    void SetNumUninitialized(int32 Count)
+    {
+        Re.SetNumUninitialized(Count, EAllowShrinking::No);
+        Im.SetNumUninitialized(Count, EAllowShrinking::No);
+    }
+};
+
+namespace OceanFFT
+{
+    // FFT 存储下标 -> 有符号的频率下标：0..(N-1)/2 为正频率，其余为负频率 (N 为偶数时 N/2 对应 -N/2)
+    inline int32 SignedFrequency(int32 Index, int32 N)
+    {
+        return (Index <= (N - 1) / 2) ? Index : Index - N;
+    }
+
+    // 按网格的 Nyquist 极限淡出短波：波长 <= Cutoff 时为 0，>= Cutoff * (1 + FadeWidth) 时为 1，中间平滑过渡
+    // Cutoff 取 2 倍格子间距 (更短的波在网格上只会变成错误的长波)，Cutoff <= 0 表示不裁剪
+    inline float GetWavelengthFade(float Wavelength, float Cutoff, float FadeWidth)
+    {
+        if (Cutoff <= 0.0f) return 1.0f;
+        const float FadeEnd = Cutoff * (1.0f + FMath::Max(FadeWidth, 0.0f));
+        if (Wavelength >= FadeEnd) return 1.0f;
+        if (Wavelength <= Cutoff) return 0.0f;
+        return FMath::SmoothStep(Cutoff, FadeEnd, Wavelength);
+    }
+}
+
+// 2D 变换的多线程设置：行 (列) 之间互不依赖，按块分给 ParallelFor 的工作线程
+struct FOceanFFTParallelSettings
+{
+    // 参与计算的线程数：0 = 自动 (全部工作线程 + 当前线程)，1 = 单线程
+    int32 NumThreads = 0;
+
+    // 每个任务块至少处理的行 (列) 数，太小的话调度开销会超过计算本身
+    int32 MinBatchSize = 8;
+};
+
+// FFT 计划 (Plan)：在 BeginPlay 中按 MeshResolution 构建一次，之后每帧复用
+// 预先计算好旋转因子 (Twiddle) 和位反转表，Tick 里只剩下蝶形运算
+// 任意长度都保持 O(N log N)：
+//   2 的幂         -> 原地 radix-2 (SIMD 蝶形)
+//   只含 2/3/5 因子 -> Stockham 混合基 (radix 4/2/3/5)
+//   其他长度       -> Bluestein (转成长度为 2 的幂的循环卷积)
+class MATHS_CW2_API FOceanFFTPlan
+{
+public:
+    enum class EAlgorithm : uint8
+    {
+        Radix2,
+        MixedRadix,
+        Bluestein,
+    };
+
+    FOceanFFTPlan() = default;
+    explicit FOceanFFTPlan(int32 InSize);
+
+    // 按给定长度重新构建 (任意 >= 1 的长度)
+    void Initialize(int32 InSize);
+
+    bool IsValid() const { return Size > 0; }
+    int32 GetSize() const { return Size; }
+    EAlgorithm GetAlgorithm() const { return Algorithm; }
+
+    static bool IsSupportedSize(int32 InSize);
+
+    // 蝶形运算是否使用 SIMD (控制台变量 ocean.FFT.SIMD，0 = 标量参考实现)
+    static bool UseSIMD();
+
+    // 单次 1D 变换需要的临时缓冲大小 (float 个数)，2 的幂时为 0
+    int32 GetWorkSize() const;
+
+    // 1D 原地逆变换：x[n] = sum X[k] * e^(i*2*PI*k*n/N)
+    // 注意：与原来的 IDFT 保持一致，不做 1/N 归一化
+    // Work 至少 GetWorkSize() 个 float (多线程时每个线程一份)
+    void InverseInPlace(float* Re, float* Im, float* Work) const;
+
+    // 同上，但指定蝶形运算的实现 (用于对比 SIMD 与标量结果)
+    void InverseInPlace(float* Re, float* Im, float* Work, bool bSIMD) const;
+
+    // 2D 原地逆变换 (Size x Size，行优先)：先做所有行，再做所有列
+    // Scratch 给每个任务块暂存一列，大小不够时会自动扩大 (之后不再分配)
+    void Inverse2D(float* Re, float* Im, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+
+    // 2D 变换拆成两步，只处理 [Begin, End) 的行 (列)：所有行做完之后才能做列
+    // 用于把一次变换分摊到多帧 (分时更新)
+    void Inverse2DRows(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+    void Inverse2DColumns(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+
+private:
+    int32 Size = 0;
+    EAlgorithm Algorithm = EAlgorithm::Radix2;
+
+    // --- Radix2 ---
+
+    // 位反转表：BitReverse[i] 是 i 的二进制翻转
+    TArray<int32> BitReverse;
+
+    // 每一级蝶形的旋转因子连续存放：长度为 L 的那一级从 L/2 开始，共 L/2 个
+    // (从 L/2 而不是 L/2-1 开始，保证 L >= 8 时每一级的起点 16 字节对齐)
+    // MixedRadix 也用这两个数组，按 Stages 中的偏移存放
+    FOceanAlignedFloatArray TwiddleRe;
+    FOceanAlignedFloatArray TwiddleIm;
+
+    void ButterfliesScalar(float* Re, float* Im) const;
+    void ButterfliesSIMD(float* Re, float* Im) const;
+
+    // --- MixedRadix (Stockham 自动排序，不需要位反转，但要一块同样大小的乒乓缓冲) ---
+
+    struct FStage
+    {
+        int32 Radix = 0;
+        int32 SubLength = 0;     // 本级之后剩下的子序列长度 m = n / Radix
+        int32 Stride = 0;        // 本级的跨度 s (之前各级基数之积)
+        int32 TwiddleOffset = 0; // 本级旋转因子在 TwiddleRe/Im 中的起点，共 m * (Radix-1) 个
+    };
+    TArray<FStage> Stages;
+
+    void InverseMixedRadix(float* Re, float* Im, float* Work) const;
+
+    // --- Bluestein ---
+
+    int32 BluesteinSize = 0;                         // >= 2N-1 的 2 的幂
+    TSharedPtr<const FOceanFFTPlan> BluesteinPlan;   // 长度 BluesteinSize 的 radix-2 计划
+    FOceanAlignedFloatArray ChirpRe;                 // w[n] = e^(+i*PI*n^2/N)
+    FOceanAlignedFloatArray ChirpIm;
+    FOceanAlignedFloatArray KernelRe;                // 卷积核的变换 (已除以 BluesteinSize)
+    FOceanAlignedFloatArray KernelIm;
+
+    void InverseBluestein(float* Re, float* Im, float* Work, bool bSIMD) const;
+};
+
+// 复数到实数 (C2R) 的逆变换计划
+// 海面高度场是实数，频谱满足共轭对称 h(-k) = conj(h(k))，所以每一行只需要 N/2+1 个频率
+// N 为偶数时，行的 C2R 用一个长度 N/2 的复数 FFT 完成，计算量和频谱内存都大约减半
+// N 为奇数时，行先按对称性补全再做长度 N 的复数 FFT (列变换仍然只做一半)
+class MATHS_CW2_API FOceanRealFFTPlan
+{
+public:
+    FOceanRealFFTPlan() = default;
+    explicit FOceanRealFFTPlan(int32 InSize);
+
+    void Initialize(int32 InSize);
+
+    bool IsValid() const { return Size > 0; }
+    int32 GetSize() const { return Size; }
+
+    // 内部长度 N 的复数计划 (可以直接拿来做打包的复数变换)
+    const FOceanFFTPlan& GetComplexPlan() const { return FullPlan; }
+
+    // 每一行存储的复数频率个数 (N/2 + 1)
+    int32 GetHalfSize() const { return Size / 2 + 1; }
+
+    static bool IsSupportedSize(int32 InSize);
+
+    // InverseRow 需要的临时缓冲大小 (float 个数)
+    int32 GetRowWorkSize() const;
+
+    // 1D：输入有 N/2+1 个频率，输出 N 个实数。Work 至少 GetRowWorkSize() 个 float
+    void InverseRow(const float* InRe, const float* InIm, float* Out, float* Work) const;
+
+    // 2D：频谱为 N 行 x (N/2+1) 列 (kx 只取非负的一半)，Out 为 N x N 实数
+    // 列变换原地进行，频谱的内容会被改写。Scratch 的用法同 FOceanFFTPlan::Inverse2D
+    void Inverse2D(float* Re, float* Im, float* Out, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+
+    // 分两步：先做 [Begin, End) 列 (共 N/2+1 列)，全部列做完之后再做 [Begin, End) 行的 C2R
+    void Inverse2DColumns(float* Re, float* Im, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+    void Inverse2DRows(const float* Re, const float* Im, float* Out, int32 Begin, int32 End, FOceanAlignedFloatArray& Scratch, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings()) const;
+
+private:
+    int32 Size = 0;
+
+    FOceanFFTPlan FullPlan; // 长度 N：列变换 (N 为奇数时也用于行)
+    FOceanFFTPlan HalfPlan; // 长度 N/2：N 为偶数时行的 C2R
+
+    // 奇偶拆分用的旋转因子 e^(+i*2*PI*k/N)，k < N/2
+    FOceanAlignedFloatArray SplitTwiddleRe;
+    FOceanAlignedFloatArray SplitTwiddleIm;
+};
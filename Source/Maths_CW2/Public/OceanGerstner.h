@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanMeshComponent.h"
+#include "OceanFFT.h"
+
+// 一帧 Gerstner 求值需要的波浪参数：指向 FGerstnerWaveTable 的各个 SoA 数组，再加上这一帧的相位
+struct FOceanGerstnerWaves
+{
+    int32 Num = 0;
+    const float* K = nullptr;
+    const float* DirX = nullptr;
+    const float* DirY = nullptr;
+    const float* Amplitude = nullptr;
+    const float* Steepness = nullptr;
+    const float* Phase = nullptr; // k*c*t
+};
+
+// Gerstner 波的求值内核：对一行等间距的顶点累加所有波，写出位移后的位置和切线
+// 基础位置为 (X0 + n*StepX, Y)，n = 0..Count-1
+namespace OceanGerstner
+{
+    // 是否使用 SIMD 内核 (控制台变量 ocean.Gerstner.SIMD，0 = 标量参考实现)
+    bool UseSIMD();
+
+    // 是否使用相位递推 (控制台变量 ocean.Gerstner.Recurrence，0 = 每个顶点每个波都求 sin / cos)
+    bool UseRecurrence();
+
+    // 相位递推需要的临时缓冲大小 (float 个数)，多线程时每个线程一份
+    int32 GetRowScratchSize(int32 NumWaves);
+
+    // 按 UseSIMD() / UseRecurrence() 选择实现。Scratch 至少 GetRowScratchSize() 个 float (16 字节对齐)，为空则不递推
+    void EvaluateRow(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch = nullptr);
+
+    // 标量参考实现：一个顶点一个波，FMath::SinCos
+    void EvaluateRowScalar(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents);
+
+    // SIMD：每次 4 个顶点对同一个波求值 (VectorSinCos 多项式近似)，不足 4 个的尾巴走标量
+    void EvaluateRowSIMD(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents);
+
+    // 规则网格专用的相位递推：沿着一行，每个波的相位每步增加同一个 k*Dx*StepX
+    // 所以只在行首求一次 sin / cos，之后每走一步乘一次旋转 e^(i*k*Dx*StepX) (复数乘法，几次乘加)
+    // 每隔一段把 (sin, cos) 拉回单位圆，避免幅度漂移
+    void EvaluateRowRecurrenceScalar(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch);
+    void EvaluateRowRecurrenceSIMD(const FOceanGerstnerWaves& Waves, float X0, float StepX, float Y, int32 Count, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, float* Scratch);
+}
+
+// 波浪很多时的 FFT 合成：逐个顶点累加是 O(顶点数 x 波数)，这里把每个波放进频率网格的一个格子里
+// 再做逆 FFT，一帧的开销是 O(波数 + N^2 log N)，和波数基本无关
+//
+// 网格有 Resolution+1 个顶点，间距 OceanSize/Resolution，FFT 的周期就是 OceanSize (最后一行/列和第一行/列重合)
+// 波矢 k*D 是 2*PI/OceanSize 整数倍的波在顶点上和 EvaluateRow 的结果一致 (只差浮点误差)
+// 其他波的波矢会吸附到最近的格子 (方向和波长最多偏 PI/OceanSize)，振幅、陡度和相位 k*c*t 保持原样
+class MATHS_CW2_API FOceanGerstnerSpectrum
+{
+public:
+    void Initialize(int32 InResolution, float InOceanSize);
+
+    bool IsValid() const { return Resolution > 0; }
+    int32 GetResolution() const { return Resolution; }
+    float GetOceanSize() const { return OceanSize; }
+
+    // 写出 (Resolution+1) x (Resolution+1) 个顶点 (行优先)，和 EvaluateRow(Waves, 0, Step, m*Step, ...) 逐行求值的布局相同
+    void Evaluate(const FOceanGerstnerWaves& Waves, FVector3f* OutPositions, FOceanMeshTangent* OutTangents, const FOceanFFTParallelSettings& Parallel = FOceanFFTParallelSettings());
+
+private:
+    int32 Resolution = 0;
+    float OceanSize = 0.0f;
+
+    FOceanFFTPlan Plan;
+
+    // 8 个实数场两两打包成 4 个复数场 (实部取 cos 项，虚部取 sin 项)：
+    //   0: X 位移 / 高度   1: Y 位移 / CurlXX   2: SlopeX / CurlYY   3: SlopeY / CurlXY
+    FOceanComplexArray Fields[4];
+    FOceanAlignedFloatArray Scratch;
+
+    void SplatWaves(const FOceanGerstnerWaves& Waves);
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+#include "PackedNormal.h"
+#include "RenderCommandFence.h"
+#include "OceanMeshComponent.generated.h" //must be the last include
+
+// 切线：与 LocalVertexFactory 的切线流格式完全一致 (TangentX, TangentZ 各 4 字节)
+// 模拟直接写这个格式，渲染线程只需要 memcpy，不再做任何转换
+struct FOceanMeshTangent
+{
+    FPackedNormal TangentX;
+    FPackedNormal TangentZ;
+};
+
+// 一帧的动态顶点流 (位置 + 切线)，已经是 GPU 格式
+// UV 和索引只在创建网格时上传一次 (静态)
+struct FOceanMeshStreams
+{
+    TArray<FVector3f> Positions;
+    TArray<FOceanMeshTangent> Tangents;
+
+    int32 Num() const { return Positions.Num(); }
+
+    // 只在变大时重新分配
+    void SetNumUninitialized(int32 Count)
+    {
+        Positions.SetNumUninitialized(Count, EAllowShrinking::No);
+        Tangents.SetNumUninitialized(Count, EAllowShrinking::No);
+    }
+};
+
+// 一种网格尺寸的静态数据：UV、初始的平面顶点流和三角形索引
+// 只是普通数组、不涉及渲染资源，可以在后台线程提前生成 (自适应分辨率切换时游戏线程不再有大循环)
+struct FOceanMeshGridTopology
+{
+    int32 NumVertsX = 0;
+    int32 NumVertsY = 0;
+    int32 NumPatches = 0;
+    float Step = 0.0f;
+
+    TArray<FVector2f> UVs;
+    FOceanMeshStreams FlatStreams;
+
+    // 可以为空：为空时由组件在创建渲染代理时生成 (同尺寸的网格已经有索引缓冲时也不会用到)
+    TArray<uint32> Indices;
+
+    int32 GetNumVertices() const { return NumVertsX * NumVertsY * NumPatches; }
+};
+
+// 海面专用的网格组件 (代替 UProceduralMeshComponent)
+// 1. 规则网格 (可以是多块同样大小的网格)：UV 和索引在 InitializeGrid 时确定，同尺寸的网格共用一份索引缓冲
+// 2. 顶点缓冲是常驻的动态缓冲，每帧只把位置和切线 memcpy 进去，不重建、不转换
+// 3. 模拟写好的流通过 SwapStreams 交给组件 (交换数组，不拷贝)
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class MATHS_CW2_API UOceanMeshComponent : public UMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+    UOceanMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+    // 海浪位移的最大范围：包围盒在平面网格基础上向各个方向扩大这么多
+    // (包围盒不随每帧的顶点更新，所以要留够余量，否则会被错误剔除)
+    UPROPERTY(EditAnywhere, Category = "Ocean Mesh", meta = (ClampMin = "0.0"))
+    float BoundsPadding = 500.0f;
+
+    // 创建 NumPatches 块 NumVertsX x NumVertsY 的规则网格 (顶点间距 Step)
+    // 每块网格的顶点连续存放，块与块之间没有三角形相连 (四叉树 LOD 每块网格单独摆放)
+    // 会重建渲染代理，分辨率改变时调用
+    void InitializeGrid(int32 InNumVertsX, int32 InNumVertsY, float InStep, int32 InNumPatches = 1);
+
+    // 同上，但使用提前生成好的拓扑 (数组直接移进组件，不拷贝)
+    void InitializeGrid(FOceanMeshGridTopology&& Topology);
+
+    // 生成网格拓扑，可以在任意线程调用。bWithIndices = false 时不生成索引
+    static FOceanMeshGridTopology BuildGridTopology(int32 InNumVertsX, int32 InNumVertsY, float InStep, int32 InNumPatches = 1, bool bWithIndices = false);
+
+    int32 GetNumVertices() const { return NumVertsX * NumVertsY * NumPatches; }
+
+    // 指定本地包围盒 (网格块会随相机移动时用)，不指定则用平面网格的范围
+    // 两种情况都会再向各个方向扩大 BoundsPadding
+    void SetLocalBounds(const FBox& InLocalBounds);
+
+    // 提交一帧新的顶点流：InOutStreams 和组件内部的暂存缓冲交换，
+    // 返回的是两帧之前提交的旧缓冲 (已经按顶点数分配好)，调用方可以直接覆盖写入
+    void SwapStreams(FOceanMeshStreams& InOutStreams);
+
+    // 由法线构造切线 (海面切线沿 X 方向)
+    static FOceanMeshTangent MakeTangent(const FVector3f& Normal)
+    {
+        FOceanMeshTangent Tangent;
+        Tangent.TangentX = FPackedNormal(FVector3f(Normal.Z, 0.0f, -Normal.X).GetSafeNormal());
+        Tangent.TangentZ = FPackedNormal(FVector4f(Normal, 1.0f));
+        return Tangent;
+    }
+
+    //~ Begin UPrimitiveComponent Interface
+    virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+    //~ End UPrimitiveComponent Interface
+
+    //~ Begin UMeshComponent Interface
+    virtual int32 GetNumMaterials() const override { return 1; }
+    //~ End UMeshComponent Interface
+
+    //~ Begin UObject Interface
+    virtual void BeginDestroy() override;
+    virtual bool IsReadyForFinishDestroy() override;
+    //~ End UObject Interface
+
+protected:
+    //~ Begin USceneComponent Interface
+    virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+    //~ End USceneComponent Interface
+
+private:
+    int32 NumVertsX = 0;
+    int32 NumVertsY = 0;
+    int32 NumPatches = 0;
+    float GridStep = 0.0f;
+
+    FBox LocalBoundsOverride = FBox(ForceInit);
+
+    // 静态 UV
+    TArray<FVector2f> UVs;
+
+    // 提前生成好的索引，创建渲染代理时交给索引缓冲 (用过就清空)
+    TArray<uint32> PreparedIndices;
+
+    // 已提交给渲染线程的两份暂存缓冲 (渲染线程从这里 memcpy 到 GPU)
+    // 每份有一个栅栏，再次写入之前确认渲染线程已经用完
+    FOceanMeshStreams PendingStreams[2];
+    FRenderCommandFence PendingFences[2];
+    int32 PendingIndex = 0;
+
+    // 最后提交的那一份 (重建渲染代理时用作初始数据)
+    int32 LastSubmittedIndex = INDEX_NONE;
+
+    // 等待所有提交给渲染线程的更新完成
+    void FlushPendingStreams();
+};
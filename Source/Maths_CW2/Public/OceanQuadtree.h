@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanMeshComponent.h"
+#include "OceanSurfaceSampler.h"
+
+// CDLOD (Continuous Distance-Dependent LOD) 四叉树
+// 整片海域是四叉树的根，每个节点是一块 PatchResolution x PatchResolution 的网格 (顶点数固定)
+// 离相机越近节点越小 (越密)，所以顶点总数随视距对数增长，而不是随海域面积平方增长
+// 每块网格都对同一块周期性的 FFT 海面采样
+struct FOceanQuadtreeSettings
+{
+    float SeaSize = 32000.0f;    // 根节点边长 (以 Actor 为中心)
+    int32 NumLevels = 7;         // LOD 层数 (0 最密)
+    int32 PatchResolution = 16;  // 每块网格的格子数 (4 的倍数)
+    float LOD0Range = 1000.0f;   // 第 0 层的可见距离，之后每层翻倍
+    float MorphStartRatio = 0.7f; // 在每层距离范围的这个比例处开始向下一层过渡 (Geomorphing)
+    int32 MaxPatches = 192;      // 最多同时显示的网格块数 (决定顶点缓冲大小，不够时去掉离相机最远的块)
+
+    // 第 Level 层一块网格的边长
+    float GetPatchSize(int32 Level) const { return SeaSize / (float)(1 << (NumLevels - 1 - Level)); }
+
+    // 每块网格的顶点数
+    int32 GetVertsPerPatch() const { return (PatchResolution + 1) * (PatchResolution + 1); }
+};
+
+// 选出来的一块网格
+struct FOceanQuadtreePatch
+{
+    FVector2f Origin = FVector2f::ZeroVector; // 左下角 (本地坐标)
+    float Size = 0.0f;
+    int32 Level = 0;
+
+    // 每个格子占几个顶点间隔：1 = 整块，2 = 只画父节点的四分之一 (保持父节点的格子大小)
+    int32 CellStride = 1;
+};
+
+namespace OceanQuadtree
+{
+    // 修正不合法的设置 (层数 / 分辨率下限、LOD0 范围必须覆盖过渡区域)
+    MATHS_CW2_API FOceanQuadtreeSettings Sanitize(const FOceanQuadtreeSettings& Settings);
+
+    // 按相机位置 (本地坐标) 选出要绘制的网格块，超过 MaxPatches 块时只保留离相机最近的
+    MATHS_CW2_API void SelectPatches(const FOceanQuadtreeSettings& Settings, const FVector3f& ViewPosition, TArray<FOceanQuadtreePatch>& OutPatches);
+
+    // 生成所有网格块的顶点：按距离做 Geomorphing，再对海面采样
+    // 没用到的网格块缩成一个点 (三角形面积为 0，不会被光栅化)
+    MATHS_CW2_API void BuildVertices(const FOceanQuadtreeSettings& Settings, const TArray<FOceanQuadtreePatch>& Patches, const FVector3f& ViewPosition, const FOceanSurfaceSampler& Sampler, FOceanMeshStreams& OutStreams);
+}
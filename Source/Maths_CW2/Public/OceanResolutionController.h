@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanResolutionController.generated.h"
+
+// 自适应分辨率的参数 (FFT 和 Gerstner 两个海浪 Actor 共用)
+USTRUCT(BlueprintType)
+struct FOceanAdaptiveResolutionSettings
+{
+    GENERATED_BODY()
+
+    // 打开后运行时按实际开销在 [Min, Max] 之间调整 MeshResolution (编辑器里设置的值作为起点)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution")
+    bool bEnabled = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution", meta = (ClampMin = "4", EditCondition = "bEnabled"))
+    int32 MinResolution = 32;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution", meta = (ClampMin = "4", EditCondition = "bEnabled"))
+    int32 MaxResolution = 256;
+
+    // 每帧模拟 + 生成顶点 + 提交的目标开销 (毫秒)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution", meta = (ClampMin = "0.01", EditCondition = "bEnabled"))
+    float TargetMs = 2.0f;
+
+    // 滞后区间：超过目标就降一档，但只有预计升档之后的开销低于 目标 x (1 - Hysteresis) 才升一档
+    // 避免在两档之间来回切换
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution", meta = (ClampMin = "0.0", ClampMax = "0.9", EditCondition = "bEnabled"))
+    float Hysteresis = 0.25f;
+
+    // 每次判断取这么多帧的平均开销 (切换之后重新计数)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Resolution", meta = (ClampMin = "1", EditCondition = "bEnabled"))
+    int32 EvaluationFrames = 60;
+};
+
+// 自适应分辨率的控制器：累计每帧的开销，每 EvaluationFrames 帧决定一次是否换一档
+// 每一档分辨率翻倍 (或减半)，限制在 [MinResolution, MaxResolution]；只做决定，真正的切换由 Actor 完成
+class MATHS_CW2_API FOceanResolutionController
+{
+public:
+    // 清空统计 (切换分辨率之后调用，新分辨率的开销重新计数)
+    void Reset();
+
+    // 记录一帧的开销，返回建议的分辨率 (不需要切换时就是 CurrentResolution)
+    int32 Update(const FOceanAdaptiveResolutionSettings& Settings, int32 CurrentResolution, float CostMs);
+
+    // 上一次判断时的平均开销
+    float GetAverageCostMs() const { return AverageCostMs; }
+
+    // 相邻的档位
+    static int32 GetLowerResolution(const FOceanAdaptiveResolutionSettings& Settings, int32 Resolution);
+    static int32 GetHigherResolution(const FOceanAdaptiveResolutionSettings& Settings, int32 Resolution);
+
+private:
+    double AccumulatedMs = 0.0;
+    int32 NumFrames = 0;
+    float AverageCostMs = 0.0f;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanFFT.h"
+#include "OceanSurfaceSampler.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+// 决定一片海况的全部参数：这些参数相同的海浪 Actor 看到的是同一片海，共用一份模拟
+struct FOceanSpectrumSettings
+{
+    int32 N = 64;                                    // FFT 分辨率
+    float OceanSize = 1000.0f;                       // 一块周期性海面的边长
+    float Amplitude = 1.0f;                          // 菲利普常数
+    FVector2D WindDirection = FVector2D(1.0f, 1.0f);
+    float WindSpeed = 20.0f;
+    float TimeScale = 1.0f;                          // 不影响频谱，但时间流速不同的海面不能共用结果
+
+    // Nyquist 裁剪：波长 <= CutoffWavelength 的频点置零 (网格画不出来)，之后的 CutoffFadeWidth 比例内平滑淡出
+    // 0 = 不裁剪。由使用这份模拟的网格中最小的格子决定 (2 倍格子大小)
+    float CutoffWavelength = 0.0f;
+    float CutoffFadeWidth = 0.5f;
+
+    bool operator==(const FOceanSpectrumSettings& Other) const
+    {
+        return N == Other.N && OceanSize == Other.OceanSize && Amplitude == Other.Amplitude &&
+            WindDirection == Other.WindDirection && WindSpeed == Other.WindSpeed && TimeScale == Other.TimeScale &&
+            CutoffWavelength == Other.CutoffWavelength && CutoffFadeWidth == Other.CutoffFadeWidth;
+    }
+
+    friend uint32 GetTypeHash(const FOceanSpectrumSettings& Settings)
+    {
+        uint32 Hash = GetTypeHash(Settings.N);
+        Hash = HashCombine(Hash, GetTypeHash(Settings.OceanSize));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.Amplitude));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.WindDirection));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.WindSpeed));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.TimeScale));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.CutoffWavelength));
+        return HashCombine(Hash, GetTypeHash(Settings.CutoffFadeWidth));
+    }
+};
+
+// 每帧模拟用到的全部临时缓冲
+// 只在分辨率改变时按 N 重新分配，Tick 里原地复用，稳定运行后每帧没有堆分配
+struct FOceanFFTWorkspace
+{
+    // 演化后的一半频谱 h(k,t)：N x (N/2+1)
+    FOceanComplexArray Spectrum;
+
+    // 打包的复数通道：高度 + i*位移X，位移Y + i*斜率X (N x N，IFFT 原地进行)
+    FOceanComplexArray PackedHeightDispX;
+    FOceanComplexArray PackedDispYSlopeX;
+
+    // 斜率 Y 的一半频谱和 C2R 输出
+    FOceanComplexArray SlopeYSpectrum;
+    FOceanAlignedFloatArray SlopeYField;
+
+    // FFT 每个任务块的临时缓冲 (第一次变换时按线程数扩大，之后不再分配)
+    FOceanAlignedFloatArray FFTScratch;
+
+    // 按分辨率 N 分配好所有缓冲
+    void Resize(int32 N)
+    {
+        const int32 HalfSize = N / 2 + 1;
+        Spectrum.SetNumUninitialized(N * HalfSize);
+        PackedHeightDispX.SetNumUninitialized(N * N);
+        PackedDispYSlopeX.SetNumUninitialized(N * N);
+        SlopeYSpectrum.SetNumUninitialized(N * HalfSize);
+        SlopeYField.SetNumUninitialized(N * N, EAllowShrinking::No);
+    }
+
+    // 释放所有内存 (分辨率变小时用，避免一直占着大分辨率的缓冲)
+    void Empty()
+    {
+        Spectrum = FOceanComplexArray();
+        PackedHeightDispX = FOceanComplexArray();
+        PackedDispYSlopeX = FOceanComplexArray();
+        SlopeYSpectrum = FOceanComplexArray();
+        SlopeYField.Empty();
+        FFTScratch.Empty();
+    }
+};
+
+// 分时更新：一次完整的演化 + IFFT 切成小块分摊到多帧
+// 每帧在预算内算一部分，显示的海面在最近两个算好的关键帧之间按时间插值
+struct FOceanTimeSliceSettings
+{
+    bool bEnabled = false;
+    float BudgetMs = 1.0f;   // 每帧最多花在模拟上的时间 (毫秒)，至少会算一块
+    int32 RowsPerChunk = 8;  // 每块处理的行 (列) 数
+};
+
+// 一片海况的 FFT 模拟：初始频谱、FFT 计划和结果缓冲
+// 由 UOceanSimulationSubsystem 按参数共享，每帧只演化 + IFFT 一次，各个 Actor 只是对结果采样的视图
+//
+// 每个请求的时间一块结果缓冲，轮流使用：这一帧的任务写新的一块，上一帧的读者 (各 Actor 的顶点任务) 还可以读旧的
+// 所有公开函数都只在游戏线程调用
+class MATHS_CW2_API FOceanSpectrumSimulation
+{
+public:
+    // 构建 FFT 计划、初始频谱和两块缓冲
+    explicit FOceanSpectrumSimulation(const FOceanSpectrumSettings& InSettings);
+
+    // 等待所有还在读写缓冲的任务
+    ~FOceanSpectrumSimulation();
+
+    UE_NONCOPYABLE(FOceanSpectrumSimulation);
+
+    const FOceanSpectrumSettings& GetSettings() const { return Settings; }
+
+    // 请求时间 Time 的海面，返回计算它的后台任务
+    // 每个时间每帧只算一次：同一帧里请求同一时间的调用者拿到同一个任务
+    // 同一帧里可能有两个时间 (同步的 Actor 要 t，异步的 Actor 提前算 t + dt)，各算一次，结果放在不同的缓冲里
+    // 分时设置由这一帧的第一个调用者决定，关键帧的推进和预算每帧只算一次，之后的时间只从已有的关键帧插值
+    UE::Tasks::FTask Simulate(float Time, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice = FOceanTimeSliceSettings());
+
+    // 这一帧结果的采样器 (Simulate 之后调用，任务完成之后才能读数据)
+    // 指针一直有效到下一帧结束 (之后这块缓冲可能被覆盖)，Choppiness 由调用者自己设置
+    FOceanSurfaceSampler GetSampler() const;
+
+    // 登记一个读这一帧结果的任务：下一次覆盖这块缓冲之前会等它完成
+    void AddReader(const UE::Tasks::FTask& Task);
+
+    // 等待所有模拟任务和读者任务
+    void Wait();
+
+    // 最近一次完成的模拟任务用了多少毫秒 (任意线程可读，自适应分辨率用)
+    float GetLastRunMs() const { return LastRunMs.load(std::memory_order_relaxed); }
+
+    // 浪高系数 (位移和斜率也要乘同一个系数)
+    static constexpr float HeightScale = 0.005f;
+
+private:
+    // 自动化测试在当前线程直接调用 Run / RunTimeSliced，统计每帧的堆分配
+    friend class FOceanSimulationNoHeapAllocationTest;
+
+    FOceanSpectrumSettings Settings;
+
+    // 打包的两个通道走复数 FFT，单独的通道走 C2R
+    FOceanRealFFTPlan FFTPlan;
+
+    // 初始频谱：只存 kx >= 0 的一半 (N x (N/2+1))，实部 / 虚部分开存放 (SoA)，方便 SIMD
+    // H0Sum = h0(k) + h0(-k)，H0Diff = h0(k) - h0(-k)，时间演化只需要这两项
+    FOceanComplexArray H0Sum;
+    FOceanComplexArray H0Diff;
+
+    // 每个频点的 |k| 和角频率 w = sqrt(g*|k|)，与频谱一起构建
+    FOceanAlignedFloatArray KMagTable;
+    FOceanAlignedFloatArray OmegaTable;
+
+    // Nyquist 裁剪之后 |频率下标| 超过这个值的行 (列) 全是 0：演化时直接清零，行 (列) 变换跳过
+    int32 CutoffIndex = 0;
+
+    // [Begin, End) 中去掉全零的 [ZeroBegin, ZeroEnd) 之后剩下的 (最多两段)，逐段调用 Body(Begin, End)
+    template <typename BodyType>
+    static void ForEachNonZeroRange(int32 Begin, int32 End, int32 ZeroBegin, int32 ZeroEnd, const BodyType& Body)
+    {
+        if (ZeroBegin >= ZeroEnd)
+        {
+            if (Begin < End) Body(Begin, End);
+            return;
+        }
+        if (Begin < FMath::Min(End, ZeroBegin)) Body(Begin, FMath::Min(End, ZeroBegin));
+        if (FMath::Max(Begin, ZeroEnd) < End) Body(FMath::Max(Begin, ZeroEnd), End);
+    }
+
+    // 一块结果缓冲：它是哪一帧 (GFrameCounter)、哪个时间的结果，最近一次写它的任务和读它的任务
+    // 第一次用到时才分配 (每帧只有一个时间的话只会用到两块)
+    struct FBuffer
+    {
+        FOceanFFTWorkspace Workspace;
+        UE::Tasks::FTask Task;
+        TArray<UE::Tasks::FTask> Readers;
+        uint64 Frame = MAX_uint64;
+        float Time = 0.0f;
+    };
+
+    // 每帧最多两个时间 (t 和 t + dt)，再加上上一帧的读者可能还在读的两块
+    static constexpr int32 NumBuffers = 4;
+    FBuffer Buffers[NumBuffers];
+
+    // 最近一次 Simulate 返回的缓冲 (GetSampler / AddReader 用)
+    int32 CurrentBuffer = 0;
+
+    // 挑一块可以写的缓冲：优先用两帧以前的，其次没用过的，再其次这一帧没用过的里最旧的
+    int32 AcquireBuffer() const;
+
+    // 这一帧第一次 Simulate 所在的帧，以及它决定的分时设置
+    uint64 SimulatedFrame = MAX_uint64;
+    FOceanTimeSliceSettings FrameTimeSlice;
+
+    // 最近一次分时任务：关键帧的状态在分时任务之间按顺序传递
+    UE::Tasks::FTask LastTimeSlicedTask;
+
+    // 一帧模拟的各个步骤，每一步内部的行 (列) 互不依赖，可以切成任意小块
+    enum class EStage : uint8
+    {
+        Evolve,         // 时间演化 (按频谱的行)
+        Pack,           // 生成打包的多通道频谱 (按行，要读镜像行，所以必须等演化全部完成)
+        ComplexRows,    // 两个打包通道的行变换
+        ComplexColumns, // 两个打包通道的列变换
+        SlopeYColumns,  // 斜率 Y 的列变换 (N/2+1 列)
+        SlopeYRows,     // 斜率 Y 的行 C2R
+        Count,
+    };
+
+    // --- 分时更新 (只在后台任务里读写，相邻两帧的任务按顺序执行) ---
+
+    // 三个关键帧：两个已经算好 (显示时在它们之间插值)，一个正在分块计算
+    struct FKeyframe
+    {
+        FOceanFFTWorkspace Workspace;
+        float Time = 0.0f;
+    };
+    FKeyframe Keyframes[3];
+    int32 OlderKey = 0;
+    int32 NewerKey = 1;
+    int32 BuildingKey = 2;
+
+    // 两个关键帧都已算好 (关掉分时之后再打开会重新开始)
+    bool bTimeSliceReady = false;
+
+    // 正在计算的关键帧做到哪一步、这一步的第几行 (列)
+    EStage BuildingStage = EStage::Evolve;
+    int32 BuildingProgress = 0;
+    float BuildingStartTime = 0.0f;
+
+    // 上一个关键帧实际用了多少模拟时间才算完：下一个关键帧的目标时间 = 开始时间 + 这个值
+    float KeyframeInterval = 1.0f / 30.0f;
+
+    // 显示相对于请求时间的延迟：每帧朝 KeyframeInterval 靠近，但变化速度有上限 (否则海面会跳一下)
+    float DisplayDelay = 1.0f / 30.0f;
+    float LastSliceTime = 0.0f;
+
+    // 后台任务写，游戏线程读
+    std::atomic<float> LastRunMs { 0.0f };
+
+    // 上一帧是否分时 (游戏线程用，决定是否重新开始)
+    bool bWasTimeSliced = false;
+
+    // 计算初始频谱和预计算表
+    void BuildSpectrum();
+
+    // 计算菲利普能量谱函数
+    float CalculatePhillips(FVector2D k) const;
+
+    // 单个频点的 h0(k)
+    void CalculateH0(int32 kxIndex, int32 kyIndex, float& OutRe, float& OutIm) const;
+
+    // 把频谱 [Begin, End) 的元素演化到时间 Time (只有一半频谱)，Begin 必须是 4 的倍数
+    void EvolveSpectrum(float Time, FOceanComplexArray& OutSpectrum, int32 Begin, int32 End) const;
+
+    // 生成 [RowBegin, RowEnd) 行的打包通道
+    void PackChannels(FOceanFFTWorkspace& Workspace, int32 RowBegin, int32 RowEnd) const;
+
+    // 演化 + IFFT，结果写入 Workspace
+    void Run(float Time, const FOceanFFTParallelSettings& Parallel, FOceanFFTWorkspace& Workspace) const;
+
+    // 一个步骤的总行 (列) 数，以及只做其中 [Begin, End) 的部分
+    int32 GetStageSize(EStage Stage) const;
+    void RunStage(EStage Stage, float Time, int32 Begin, int32 End, const FOceanFFTParallelSettings& Parallel, FOceanFFTWorkspace& Workspace) const;
+
+    // 分时模式的一帧：在预算内推进正在计算的关键帧，再把两个算好的关键帧插值到 Output
+    // bAdvance = false 时 (同一帧里的第二个时间) 不推进关键帧、不花预算，也不更新显示延迟，只做插值
+    void RunTimeSliced(float Time, const FOceanFFTParallelSettings& Parallel, const FOceanTimeSliceSettings& TimeSlice, bool bRestart, bool bAdvance, FOceanFFTWorkspace& Output);
+
+    // 开始计算一个新的关键帧 (目标时间 Time)
+    void StartKeyframe(float Time, float RequestTime);
+
+    // 推进一块，返回这个关键帧是否已经算完
+    bool RunKeyframeChunk(const FOceanFFTParallelSettings& Parallel, int32 RowsPerChunk);
+
+    // 正在计算的关键帧还剩多少块
+    int32 GetRemainingChunks(int32 RowsPerChunk) const;
+
+    // 两个关键帧按时间线性插值 (Time 超出范围时取端点)
+    void BlendKeyframes(float Time, FOceanFFTWorkspace& Output) const;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "OceanSimulation.h"
+#include "OceanSimulationSubsystem.generated.h"
+
+// 关卡里所有海浪 Actor 共用的模拟
+// 按频谱参数 (FOceanSpectrumSettings) 查找：参数相同的 Actor 拿到同一份模拟，每帧只算一次
+// 子系统只保存弱引用，最后一个持有的 Actor 释放之后模拟随之销毁
+UCLASS()
+class MATHS_CW2_API UOceanSimulationSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // 取得这组参数的模拟，没有就新建一个 (构建 FFT 计划和初始频谱)
+    TSharedRef<FOceanSpectrumSimulation> AcquireSimulation(const FOceanSpectrumSettings& Settings);
+
+    // 只查找，不新建 (没有就返回空)
+    TSharedPtr<FOceanSpectrumSimulation> FindSimulation(const FOceanSpectrumSettings& Settings) const;
+
+    // 登记一份在别处 (比如后台任务里) 建好的模拟
+    // 期间已经有人建了同样参数的模拟的话，返回已有的那份，传进来的这份丢掉
+    TSharedRef<FOceanSpectrumSimulation> RegisterSimulation(const TSharedRef<FOceanSpectrumSimulation>& Simulation);
+
+    // 当前还活着的模拟个数
+    int32 GetNumSimulations() const;
+
+    virtual void Deinitialize() override;
+
+private:
+    TMap<FOceanSpectrumSettings, TWeakPtr<FOceanSpectrumSimulation>> Simulations;
+};
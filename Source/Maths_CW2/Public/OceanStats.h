@@ -0,0 +1,7 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// 海面模拟的性能统计 (控制台输入 stat Ocean 查看)
+DECLARE_STATS_GROUP(TEXT("Ocean"), STATGROUP_Ocean, STATCAT_Advanced);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 对 FFT 结果 (一块周期性的 N x N 海面) 按任意位置采样
+// 只保存指向各个通道的指针，不拷贝数据：指针在下一次模拟写同一块缓冲之前有效
+// 海面在 X / Y 方向以 TileSize 为周期无限平铺，格点之间双线性插值
+struct FOceanSurfaceSampler
+{
+    const float* Height = nullptr;
+    const float* DispX = nullptr;
+    const float* DispY = nullptr;
+    const float* SlopeX = nullptr;
+    const float* SlopeY = nullptr;
+
+    int32 N = 0;
+    float TileSize = 0.0f;
+    float HeightScale = 0.0f;  // 浪高系数 (位移和斜率都要乘)
+    float Choppiness = 0.0f;
+
+    bool IsValid() const
+    {
+        return N > 0 && TileSize > 0.0f && Height && DispX && DispY && SlopeX && SlopeY;
+    }
+
+    // 采样 (X, Y) 处的位移 (水平 Choppy 偏移 + 高度) 和法线
+    void Sample(float X, float Y, FVector3f& OutOffset, FVector3f& OutNormal) const
+    {
+        // 1. 世界坐标 -> 格点坐标，取整数部分和小数部分
+        const float GridX = X * N / TileSize;
+        const float GridY = Y * N / TileSize;
+        const float FloorX = FMath::FloorToFloat(GridX);
+        const float FloorY = FMath::FloorToFloat(GridY);
+        const float Fx = GridX - FloorX;
+        const float Fy = GridY - FloorY;
+
+        // 2. 周期性取模 (负数也要映射到 [0, N))
+        int32 x0 = (int32)FloorX % N; if (x0 < 0) x0 += N;
+        int32 y0 = (int32)FloorY % N; if (y0 < 0) y0 += N;
+        const int32 x1 = (x0 + 1 == N) ? 0 : x0 + 1;
+        const int32 y1 = (y0 + 1 == N) ? 0 : y0 + 1;
+
+        const int32 i00 = y0 * N + x0, i10 = y0 * N + x1;
+        const int32 i01 = y1 * N + x0, i11 = y1 * N + x1;
+        const float w00 = (1.0f - Fx) * (1.0f - Fy), w10 = Fx * (1.0f - Fy);
+        const float w01 = (1.0f - Fx) * Fy,          w11 = Fx * Fy;
+
+        auto Bilinear = [&](const float* Field)
+        {
+            return Field[i00] * w00 + Field[i10] * w10 + Field[i01] * w01 + Field[i11] * w11;
+        };
+
+        // 3. x' = x + Choppiness * D，其中 D = -位移通道；法线 n = normalize(-dh/dx, -dh/dy, 1)
+        OutOffset = FVector3f(-Choppiness * Bilinear(DispX), -Choppiness * Bilinear(DispY), Bilinear(Height)) * HeightScale;
+        OutNormal = FVector3f(-Bilinear(SlopeX) * HeightScale, -Bilinear(SlopeY) * HeightScale, 1.0f).GetSafeNormal();
+    }
+};